@@ -69,6 +69,18 @@ struct __attribute__((__packed__)) message_header {
  */
 #define GNUNET_MESSAGE_TYPE_SEARCH_FLOODING 0x2424
 
+/**
+ * @brief This constant defines the GNUnet DHT block type used for URL records; peers monitor puts of that type in order to crawl
+ * the URLs published. The block types of GNUnet Search are handled by the block plugin libgnunet_plugin_block_search which has to be
+ * installed with GNUnet.
+ */
+#define GNUNET_BLOCK_TYPE_SEARCH_URL 0x4242
+
+/**
+ * @brief This constant defines the GNUnet DHT block type used for keyword postings mapping a keyword to an URL.
+ */
+#define GNUNET_BLOCK_TYPE_SEARCH_KEYWORD 0x4243
+
 /**
  * @brief This constant defines a numerical code used by the client to tell the service that
  * the request sent is a search request.
@@ -82,6 +94,37 @@ struct __attribute__((__packed__)) message_header {
  */
 #define GNUNET_SEARCH_ACTION_ADD 0x01
 
+/**
+ * @brief This constant defines a numerical code used by the client to tell the service that
+ * the request sent cancels a search request sent before. The id of the command is the id of the
+ * search request to cancel; the service answers with a done response using that id.
+ */
+#define GNUNET_SEARCH_ACTION_CANCEL 0x02
+
+/**
+ * @brief This constant defines a numerical code used by the client to tell the service to forward
+ * a search request using the forwarding strategy configured for the service.
+ */
+#define GNUNET_SEARCH_FORWARDING_DEFAULT 0x00
+
+/**
+ * @brief This constant defines a numerical code used to select the forwarding strategy that floods
+ * a search request to all neighbours.
+ */
+#define GNUNET_SEARCH_FORWARDING_FLOOD 0x01
+
+/**
+ * @brief This constant defines a numerical code used to select the forwarding strategy that forwards
+ * a search request to a random subset of the neighbours (gossip).
+ */
+#define GNUNET_SEARCH_FORWARDING_GOSSIP 0x02
+
+/**
+ * @brief This constant defines a numerical code used to select the forwarding strategy that sends
+ * a search request along multiple random walks.
+ */
+#define GNUNET_SEARCH_FORWARDING_WALK 0x03
+
 /**
  * @brief This data structure is sent to the service; it contains attributes needed to process
  * a client's request. As the client and service are thought to run on the same machine the
@@ -106,6 +149,29 @@ struct __attribute__((__packed__)) search_command {
 	 * GNUnet messages received for that request).
 	 */
 	uint64_t size;
+	/**
+	 * This member defines the forwarding strategy used for a search request. For more details see
+	 * the constant definitions above; GNUNET_SEARCH_FORWARDING_DEFAULT selects the strategy configured
+	 * for the service.
+	 */
+	uint8_t forwarding;
+	/**
+	 * This member defines the fanout of the forwarding strategy, i.e. the number of neighbours a request
+	 * is gossiped to or the number of random walkers. A value of 0 selects the configured fanout.
+	 */
+	uint8_t fanout;
+	/**
+	 * This member defines the maximal number of results the client is interested in for a search request.
+	 * Peers stop forwarding the request and its responses once that many distinct results have been
+	 * returned. A value of 0 requests all results.
+	 */
+	uint16_t max_results;
+	/**
+	 * This member defines the deadline of a search request in milliseconds. The service sends a done
+	 * response and stops the search once the deadline has passed. A value of 0 selects the deadline
+	 * configured for the service.
+	 */
+	uint32_t deadline;
 };
 
 /**
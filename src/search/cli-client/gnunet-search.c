@@ -43,6 +43,18 @@
  * @brief This constant defines the string representation for the URL add action. It is used to match the user's command line options.
  */
 #define GNUNET_SEARCH_ACTION_STRING_ADD "add"
+/**
+ * @brief This constant defines the string representation for the flooding forwarding strategy. It is used to match the user's command line options.
+ */
+#define GNUNET_SEARCH_FORWARDING_STRING_FLOOD "flood"
+/**
+ * @brief This constant defines the string representation for the gossip forwarding strategy. It is used to match the user's command line options.
+ */
+#define GNUNET_SEARCH_FORWARDING_STRING_GOSSIP "gossip"
+/**
+ * @brief This constant defines the string representation for the random walk forwarding strategy. It is used to match the user's command line options.
+ */
+#define GNUNET_SEARCH_FORWARDING_STRING_WALK "walk"
 
 static int ret;
 
@@ -58,6 +70,22 @@ static char *file_string;
  * @brief This variable stores the string given by the user for the search keyword command line parameter.
  */
 static char *keyword_string;
+/**
+ * @brief This variable stores the string given by the user for the forwarding strategy command line parameter.
+ */
+static char *forwarding_string;
+/**
+ * @brief This variable stores the fanout given by the user for the forwarding strategy.
+ */
+static unsigned int fanout;
+/**
+ * @brief This variable stores the maximal number of results given by the user.
+ */
+static unsigned int max_results;
+/**
+ * @brief This variable stores the deadline of the search request in milliseconds given by the user.
+ */
+static unsigned int deadline;
 
 /**
  * @brief This function handles a buffer newly received by the communication component.
@@ -68,10 +96,11 @@ static char *keyword_string;
  * to a specific message. The completeness of the message has to be verified (e.g. by comparing the size of the message with
  * the length of data received).
  *
+ * @param session_cls the closure of the communication session (not used)
  * @param size the actual size of the buffer received
  * @param buffer the buffer containing the fragments received
  */
-static void gnunet_search_receive_handler(size_t size, void *buffer) {
+static void gnunet_search_receive_handler(void *session_cls, size_t size, void *buffer) {
 	GNUNET_assert(size >= sizeof(struct search_response));
 	if(size < sizeof(struct search_response))
 		return;
@@ -137,11 +166,33 @@ static void gnunet_search_transmit_urls(const char *file) {
 		GNUNET_free(urls[i]);
 	GNUNET_free(urls);
 
-	gnunet_search_communication_transmit(serialized, serialized_size);
+	gnunet_search_server_communication_transmit(serialized, serialized_size);
 
 	GNUNET_free(serialized);
 }
 
+/**
+ * @brief This function determines the forwarding strategy chosen by the user.
+ *
+ * @param forwarding a reference to the variable to store the forwarding strategy in
+ *
+ * @return a boolean value indicating whether the strategy given by the user is known (1) or not (0)
+ */
+static char gnunet_search_forwarding_get(uint8_t *forwarding) {
+	*forwarding = GNUNET_SEARCH_FORWARDING_DEFAULT;
+	if(!forwarding_string)
+		return 1;
+	if(!strcmp(forwarding_string, GNUNET_SEARCH_FORWARDING_STRING_FLOOD))
+		*forwarding = GNUNET_SEARCH_FORWARDING_FLOOD;
+	else if(!strcmp(forwarding_string, GNUNET_SEARCH_FORWARDING_STRING_GOSSIP))
+		*forwarding = GNUNET_SEARCH_FORWARDING_GOSSIP;
+	else if(!strcmp(forwarding_string, GNUNET_SEARCH_FORWARDING_STRING_WALK))
+		*forwarding = GNUNET_SEARCH_FORWARDING_WALK;
+	else
+		return 0;
+	return 1;
+}
+
 /**
  * @brief This function transmit a request for a keyword to the service.
  *
@@ -165,8 +216,12 @@ static void gnunet_search_transmit_keyword(const char *keyword) {
 	cmd->action = GNUNET_SEARCH_ACTION_SEARCH;
 	cmd->size = serialized_size;
 	cmd->id = 0;
+	gnunet_search_forwarding_get(&cmd->forwarding);
+	cmd->fanout = fanout > UINT8_MAX ? UINT8_MAX : fanout;
+	cmd->max_results = max_results > UINT16_MAX ? UINT16_MAX : max_results;
+	cmd->deadline = deadline;
 
-	gnunet_search_communication_transmit(serialized, serialized_size);
+	gnunet_search_server_communication_transmit(serialized, serialized_size);
 
 	GNUNET_free(serialized);
 }
@@ -199,6 +254,12 @@ static void gnunet_search_run(void *cls, char * const *args, const char *cfgfile
 //	printf("action: %s\n", action_string);
 //	printf("file: %s\n", file_string);
 
+	uint8_t forwarding;
+	if(!gnunet_search_forwarding_get(&forwarding)) {
+		fprintf(stderr, "Unknown forwarding strategy '%s'; use flood, gossip or walk.\n", forwarding_string);
+		exit(1);
+	}
+
 	char success = gnunet_search_server_communication_init(cfg);
 	if(!success) {
 		printf("Unable to connect to service.\n");
@@ -227,7 +288,15 @@ int main(int argc, char * const *argv) {
 			gettext_noop("search for keyword or add list of urls"), 1, &GNUNET_GETOPT_set_string, &action_string }, {
 			'u', "urls", "path/to/file", gettext_noop("specify the file containing urls"), 1, &GNUNET_GETOPT_set_string,
 			&file_string }, { 'k', "keyword", "keyword", gettext_noop("specify the keyword to search for"), 1,
-			&GNUNET_GETOPT_set_string, &keyword_string }, GNUNET_GETOPT_OPTION_END };
+			&GNUNET_GETOPT_set_string, &keyword_string }, { 's', "strategy", "flood|gossip|walk",
+			gettext_noop("specify the forwarding strategy for the search request"), 1, &GNUNET_GETOPT_set_string,
+			&forwarding_string }, { 'f', "fanout", "fanout",
+			gettext_noop("specify the gossip fanout or the number of random walkers"), 1, &GNUNET_GETOPT_set_uint,
+			&fanout }, { 'n', "max-results", "count",
+			gettext_noop("specify the maximal number of results to search for"), 1, &GNUNET_GETOPT_set_uint,
+			&max_results }, { 'd', "deadline", "milliseconds",
+			gettext_noop("specify the time after which the search request is finished"), 1, &GNUNET_GETOPT_set_uint,
+			&deadline }, GNUNET_GETOPT_OPTION_END };
 	return (GNUNET_OK
 			== GNUNET_PROGRAM_run(argc, argv, "gnunet-search [options [value]]", gettext_noop("search"), options, &gnunet_search_run,
 					NULL)) ? ret : 1;
@@ -39,6 +39,10 @@
  * @brief This variable stores a reference to the GNUnet client connection.
  */
 static struct GNUNET_CLIENT_Connection *gnunet_search_server_communication_client_connection;
+/**
+ * @brief This variable stores a reference to the communication session of the connection to the service.
+ */
+static struct gnunet_search_communication_session *gnunet_search_server_communication_session;
 
 /**
  * @brief This is function is the handler used by GNUnet to tell the client about new messages.
@@ -48,7 +52,8 @@ static struct GNUNET_CLIENT_Connection *gnunet_search_server_communication_clien
  */
 static void gnunet_search_server_communication_receive_response(void *cls,
 		const struct GNUNET_MessageHeader *gnunet_message) {
-	char more_messages = gnunet_search_communication_receive(gnunet_message);
+	char more_messages = gnunet_search_communication_receive(gnunet_search_server_communication_session,
+			gnunet_message);
 	if(more_messages)
 		GNUNET_CLIENT_receive(gnunet_search_server_communication_client_connection,
 				&gnunet_search_server_communication_receive_response, NULL, GNUNET_TIME_relative_get_forever_());
@@ -64,16 +69,28 @@ static void gnunet_search_server_communication_receive_response(void *cls,
  * API functions and data structures are offered. In order to nevertheless implement a generic communication component both the client and the
  * service have to implement their own generic handlers. These generic handlers then call the specific GNUnet API functions for transmission.
  *
+ * @session_cls the closure of the communication session (not used since the client only has one session)
  * @size the size of the message
  * @cls the GNUnet closure for the GNUnet API call
  * @handler the function within the generic communication component that handles the message transmission
+ *
+ * @return the GNUnet transmit handle; it is NULL in case the transmission could not be requested.
  */
-static void gnunet_search_server_communication_request_notify_transmit_ready(size_t size, void *cls,
+static void *gnunet_search_server_communication_request_notify_transmit_ready(void *session_cls, size_t size, void *cls,
 		size_t (*handler)(void*, size_t, void*), struct GNUNET_TIME_Relative max_delay) {
-	GNUNET_CLIENT_notify_transmit_ready(gnunet_search_server_communication_client_connection, size, max_delay, 1,
+	return GNUNET_CLIENT_notify_transmit_ready(gnunet_search_server_communication_client_connection, size, max_delay, 1,
 			handler, cls);
 }
 
+/**
+ * @brief This function cancels a transmission requested using the function above.
+ *
+ * @param transmit_handle the GNUnet transmit handle
+ */
+static void gnunet_search_server_communication_notify_transmit_ready_cancel(void *transmit_handle) {
+	GNUNET_CLIENT_notify_transmit_ready_cancel((struct GNUNET_CLIENT_TransmitHandle*) transmit_handle);
+}
+
 /**
  * @brief This function is used by other components to initiate the recipience of a new message.
  *
@@ -96,7 +113,9 @@ void gnunet_search_server_communication_receive() {
  */
 char gnunet_search_server_communication_init(const struct GNUNET_CONFIGURATION_Handle *cfg) {
 	gnunet_search_server_communication_client_connection = GNUNET_CLIENT_connect("search", cfg);
-	gnunet_search_communication_init(&gnunet_search_server_communication_request_notify_transmit_ready);
+	gnunet_search_communication_init(&gnunet_search_server_communication_request_notify_transmit_ready,
+			&gnunet_search_server_communication_notify_transmit_ready_cancel);
+	gnunet_search_server_communication_session = gnunet_search_communication_session_create(NULL);
 	return gnunet_search_server_communication_client_connection != NULL;
 }
 
@@ -104,8 +123,22 @@ char gnunet_search_server_communication_init(const struct GNUNET_CONFIGURATION_H
  * @brief This function releases all resources held by the server communication component and shuts down the GNUnet client connection.
  */
 void gnunet_search_server_communication_free() {
+	/*
+	 * The session has to be freed first since it may hold a transmit handle of the connection.
+	 */
+	gnunet_search_communication_session_free(gnunet_search_server_communication_session);
 	if(gnunet_search_server_communication_client_connection)
 		GNUNET_CLIENT_disconnect(gnunet_search_server_communication_client_connection);
 
 	gnunet_search_communication_free();
 }
+
+/**
+ * @brief This function transmits data to the service.
+ *
+ * @param data the data to send
+ * @param size the size of the data
+ */
+void gnunet_search_server_communication_transmit(void *data, size_t size) {
+	gnunet_search_communication_transmit(gnunet_search_server_communication_session, data, size);
+}
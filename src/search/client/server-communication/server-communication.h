@@ -34,5 +34,6 @@
 extern void gnunet_search_server_communication_receive();
 extern char gnunet_search_server_communication_init(const struct GNUNET_CONFIGURATION_Handle *cfg);
 extern void gnunet_search_server_communication_free();
+extern void gnunet_search_server_communication_transmit(void *data, size_t size);
 
 #endif /* SERVER_COMMUNICATION_C_ */
@@ -9,7 +9,8 @@
  * \em Detailed \em description \n
  * This file contains all functions pertaining to the GNUnet Search communication component. This component implements generic communication functionality used
  * by the service and the client. It takes care of sending and receiving messages and storing outgoing data in a queue. Furthermore it handles the fragmentation
- * of messages in order to enable the exchange of data of arbitrary size.
+ * of messages in order to enable the exchange of data of arbitrary size. All state belonging to one connection is kept in a session; the client uses a single
+ * session while the service uses one session per connected client.
  */
 /*
  *  This file is part of GNUnet Search.
@@ -38,6 +39,7 @@
 #include <gnunet/gnunet_util_lib.h>
 #include "gnunet_protocols_search.h"
 #include "communication.h"
+#include "pool.h"
 
 #include <collections/queue/queue.h>
 #include <collections/arraylist/arraylist.h>
@@ -46,16 +48,6 @@
  * @brief This variable stores references to all subscribed listeners; see below for more details.
  */
 static array_list_t *gnunet_search_communication_listeners;
-/**
- * @brief This variable implements an output queue for messages.
- *
- * \latexonly \\ \\ \endlatexonly
- * \em Detailed \em description \n
- * This variable implements an output queue for messages. Since GNUnet does not allow the user to
- * queue more than one message at a time it is important to handle this situation correctly. New
- * mesage are enqueued in this queue and are sent subequently one after one.
- */
-static queue_t *gnunet_search_communication_message_queue;
 /**
  * @brief This variable stores a reference to a function which calls the respective notify transmit ready
  * function of GNUnet.
@@ -67,9 +59,15 @@ static queue_t *gnunet_search_communication_message_queue;
  * for message transmission on the service and client side; while the functionality does not differ and the process steps are the same, different
  * API functions and data structures are offered. In order to nevertheless implement a generic communication component both the client and the
  * service have to implement their own generic handlers. These generic handlers then call the specific GNUnet API functions for transmission.
+ * The first parameter of the handler is the closure of the session the message belongs to; the handler returns the GNUnet transmit handle
+ * or NULL in case the transmission could not be requested.
  */
-static void (*gnunet_search_communication_request_notify_transmit_ready)(size_t size, void *cls,
+static void *(*gnunet_search_communication_request_notify_transmit_ready)(void *session_cls, size_t size, void *cls,
 		size_t (*)(void*, size_t, void*), struct GNUNET_TIME_Relative);
+/**
+ * @brief This variable stores a reference to a function which cancels a transmission requested using the function above.
+ */
+static void (*gnunet_search_communication_notify_transmit_ready_cancel)(void *transmit_handle);
 
 /**
  * @brief This data structure is used to combine all parameters needed for a message waiting in the output queue.
@@ -85,6 +83,53 @@ struct gnunet_search_communication_queued_message {
 	size_t size;
 };
 
+/**
+ * @brief This data structure stores the state of a communication session, i.e. of one connection between the service and a client.
+ */
+struct gnunet_search_communication_session {
+	/**
+	 * @brief This member stores the closure of the session; it is passed to the transmission handler and to the listeners.
+	 */
+	void *cls;
+	/**
+	 * @brief This member implements an output queue for messages.
+	 *
+	 * \latexonly \\ \\ \endlatexonly
+	 * \em Detailed \em description \n
+	 * This member implements an output queue for messages. Since GNUnet does not allow the user to
+	 * queue more than one message at a time it is important to handle this situation correctly. New
+	 * mesage are enqueued in this queue and are sent subequently one after one.
+	 */
+	queue_t *message_queue;
+	/**
+	 * @brief This member stores a reference to the message currently being transmitted; it is NULL in case no message is in flight.
+	 *
+	 * \latexonly \\ \\ \endlatexonly
+	 * \em Detailed \em description \n
+	 * This member stores a reference to the message currently being transmitted; it is NULL in case no message is in flight. Only one message is
+	 * handed to GNUnet at a time; the message and its buffer are owned by the session until the transmission completes or fails and are returned
+	 * to the buffer pool afterwards.
+	 */
+	struct gnunet_search_communication_queued_message *transmitting;
+	/**
+	 * @brief This member stores the GNUnet transmit handle of the message in flight; it is NULL in case GNUnet does not hold a pending
+	 * transmission request of the session.
+	 */
+	void *transmit_handle;
+	/**
+	 * @brief This member stores the task initiating the transmission of the next message.
+	 */
+	GNUNET_SCHEDULER_TaskIdentifier transmit_task;
+	/**
+	 * @brief This member stores the task releasing the message in flight in case GNUnet does not report the completion of its transmission.
+	 */
+	GNUNET_SCHEDULER_TaskIdentifier transmit_timeout_task;
+	/**
+	 * @brief This member stores the fragments of the message currently being received.
+	 */
+	queue_t *fragments;
+};
+
 /**
  * @brief This function notifies all listeners about a newly arrived message.
  *
@@ -93,42 +138,95 @@ struct gnunet_search_communication_queued_message {
  * This function notifies all listeners about a newly arrived message. It is important to note that a message may be fragmented and thus
  * consist of multiple GNUnet messages.
  *
+ * @param session the session the message has been received on
  * @param size the size of the new message
  * @param buffer the buffer containing the new message
  */
-static void gnunet_search_communication_listeners_notify(size_t size, void *buffer) {
+static void gnunet_search_communication_listeners_notify(struct gnunet_search_communication_session *session, size_t size,
+		void *buffer) {
 	for(long int i = 0; i < array_list_get_length(gnunet_search_communication_listeners); ++i) {
-		void (*listener)(size_t, void*);
+		void (*listener)(void*, size_t, void*);
 		array_list_get(gnunet_search_communication_listeners, (const void**) &listener, i);
-		listener(size, buffer);
+		listener(session->cls, size, buffer);
 	}
 }
 
 static void gnunet_search_communication_transmit_next(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc);
 
+/**
+ * @brief This function schedules the transmission of the next message of a session unless it is already scheduled.
+ *
+ * @param session the session
+ */
+static void gnunet_search_communication_transmit_schedule(struct gnunet_search_communication_session *session) {
+	if(session->transmit_task == GNUNET_SCHEDULER_NO_TASK)
+		session->transmit_task = GNUNET_SCHEDULER_add_delayed(GNUNET_TIME_UNIT_ZERO,
+				&gnunet_search_communication_transmit_next, session);
+}
+
+/**
+ * @brief This function returns a previously queued message and its buffer to the buffer pool.
+ *
+ * @param msg the message to release
+ */
+static void gnunet_search_communication_queued_message_release(struct gnunet_search_communication_queued_message *msg) {
+	gnunet_search_pool_release(msg->buffer);
+	gnunet_search_pool_release(msg);
+}
+
+/**
+ * @brief This function completes the transmission of the message in flight.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function completes the transmission of the message in flight. The message is released, whether it has been sent or not, and the
+ * transmission of the next message waiting in the output queue is initiated.
+ *
+ * @param session the session
+ */
+static void gnunet_search_communication_transmit_complete(struct gnunet_search_communication_session *session) {
+	if(session->transmit_timeout_task != GNUNET_SCHEDULER_NO_TASK) {
+		GNUNET_SCHEDULER_cancel(session->transmit_timeout_task);
+		session->transmit_timeout_task = GNUNET_SCHEDULER_NO_TASK;
+	}
+	gnunet_search_communication_queued_message_release(session->transmitting);
+	session->transmitting = NULL;
+
+	gnunet_search_communication_transmit_schedule(session);
+}
+
 /**
  * @brief This function is called by GNUnet is case a new buffer is available for a message to be sent.
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
  * This function is called by GNUnet is case a new buffer is available for a message to be sent. This function also takes
- * care of initiating the transmission of the next message waiting in the output queue.
+ * care of initiating the transmission of the next message waiting in the output queue. GNUnet passes a NULL buffer in case the
+ * transmission failed; the message is dropped in that case.
  *
- * @param cls the GNUnet closure
+ * @param cls the GNUnet closure containing a reference to the session
  * @param size the amout of buffer space available
  * @param buffer the output buffer the message shall be written to
  *
  * @return the amout of buffer space written
  */
 static size_t gnunet_search_communication_transmit_ready(void *cls, size_t size, void *buffer) {
-	size_t msg_size = sizeof(struct GNUNET_MessageHeader);
+	struct gnunet_search_communication_session *session = (struct gnunet_search_communication_session*) cls;
+	session->transmit_handle = NULL;
+
+	/*
+	 * The message has already been released by the timeout task.
+	 */
+	if(!session->transmitting)
+		return 0;
 
-	struct gnunet_search_communication_queued_message *msg = (struct gnunet_search_communication_queued_message*) cls;
-	msg_size += msg->size;
+	struct gnunet_search_communication_queued_message *msg = session->transmitting;
+	size_t msg_size = sizeof(struct GNUNET_MessageHeader) + msg->size;
 
-	GNUNET_assert(size >= msg_size);
-	if(size < msg_size)
+	if(!buffer || size < msg_size) {
+		gnunet_search_communication_transmit_complete(session);
 		return 0;
+	}
 
 	struct GNUNET_MessageHeader *header = (struct GNUNET_MessageHeader*) buffer;
 	header->type = GNUNET_MESSAGE_TYPE_SEARCH;
@@ -136,34 +234,33 @@ static size_t gnunet_search_communication_transmit_ready(void *cls, size_t size,
 
 	memcpy(buffer + sizeof(struct GNUNET_MessageHeader), msg->buffer, msg->size);
 
-//	free(msg->buffer);
-//	free(msg);
-
-//printf("End of transmit_ready()...\n");
-
-	GNUNET_SCHEDULER_add_delayed(GNUNET_TIME_UNIT_ZERO, &gnunet_search_communication_transmit_next, NULL);
+	gnunet_search_communication_transmit_complete(session);
 
 	return msg_size;
 }
 
 /**
- * @brief This function frees a previously queued message and its buffer.
+ * @brief This function releases the message in flight in case GNUnet did not report the completion of its transmission.
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This function frees a previously queued message and its buffer. GNUnet does not call transmit_ready() in case an error occurs.
- * In that case the transmit_ready() function cannot take care of freeing the message data structure and the buffer. In order to solve that problem
- * this handler is scheduled to be called after the transmit_ready() function call. As this is a ordinary scheduled task it is called
- * despite possible communication errors. For this reason the approch prevents memory leaks.
+ * This function releases the message in flight in case GNUnet did not report the completion of its transmission. GNUnet does not call
+ * transmit_ready() in case some errors occur; this handler is scheduled to be called after the maximal transmission delay and makes sure the
+ * message does not block the output queue forever. The pending transmission request is cancelled so that GNUnet does not call
+ * transmit_ready() for a message already released.
  *
- * @param cls the GNUnet closure containing a reference to message to be freed
- * @tc the GNUnet task context (not used)
+ * @param cls the GNUnet closure containing a reference to the session
+ * @param tc the GNUnet task context (not used)
  */
-static void gnunet_search_communication_queued_message_free_task(void *cls,
-		const struct GNUNET_SCHEDULER_TaskContext *tc) {
-	struct gnunet_search_communication_queued_message *msg = (struct gnunet_search_communication_queued_message*) cls;
-	GNUNET_free(msg->buffer);
-	GNUNET_free(msg);
+static void gnunet_search_communication_transmit_timeout(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc) {
+	struct gnunet_search_communication_session *session = (struct gnunet_search_communication_session*) cls;
+	session->transmit_timeout_task = GNUNET_SCHEDULER_NO_TASK;
+	if(session->transmit_handle) {
+		gnunet_search_communication_notify_transmit_ready_cancel(session->transmit_handle);
+		session->transmit_handle = NULL;
+	}
+	if(session->transmitting)
+		gnunet_search_communication_transmit_complete(session);
 }
 
 /**
@@ -174,29 +271,30 @@ static void gnunet_search_communication_queued_message_free_task(void *cls,
  * This function initiates the transmission of the next message. In order to do that it dequeues the message from the
  * output queue and requests the service or client communication component to call the appropriate GNUnet function for the
  * transmission of the message. The function is implemented as a GNUnet task; this is done in order to decouple it from the
- * transmit_ready() function call (see above).
+ * transmit_ready() function call (see above). Nothing is done while another message of the session is in flight.
  *
- * @param cls the GNUnet closure (not used)
+ * @param cls the GNUnet closure containing a reference to the session
  * @param tc the GNUnet task context (not used)
  */
 static void gnunet_search_communication_transmit_next(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc) {
-	if(!queue_get_length(gnunet_search_communication_message_queue))
+	struct gnunet_search_communication_session *session = (struct gnunet_search_communication_session*) cls;
+	session->transmit_task = GNUNET_SCHEDULER_NO_TASK;
+
+	if(session->transmitting || !queue_get_length(session->message_queue))
 		return;
 
 	struct gnunet_search_communication_queued_message *msg =
-			(struct gnunet_search_communication_queued_message*) queue_dequeue(
-					gnunet_search_communication_message_queue);
+			(struct gnunet_search_communication_queued_message*) queue_dequeue(session->message_queue);
+	session->transmitting = msg;
 
 	struct GNUNET_TIME_Relative max_delay = GNUNET_TIME_relative_get_minute_();
 	struct GNUNET_TIME_Relative gct = GNUNET_TIME_relative_add(max_delay, GNUNET_TIME_relative_get_second_());
 
-	gnunet_search_communication_request_notify_transmit_ready(sizeof(struct GNUNET_MessageHeader) + msg->size, msg,
-			&gnunet_search_communication_transmit_ready, max_delay);
-
-	/*
-	 * Todo: Save and free...
-	 */
-	GNUNET_SCHEDULER_add_delayed(gct, &gnunet_search_communication_queued_message_free_task, msg);
+	session->transmit_timeout_task = GNUNET_SCHEDULER_add_delayed(gct, &gnunet_search_communication_transmit_timeout,
+			session);
+	session->transmit_handle = gnunet_search_communication_request_notify_transmit_ready(session->cls,
+			sizeof(struct GNUNET_MessageHeader) + msg->size, session, &gnunet_search_communication_transmit_ready,
+			max_delay);
 }
 
 /**
@@ -204,47 +302,81 @@ static void gnunet_search_communication_transmit_next(void *cls, const struct GN
  *
  * @param request_notify_transmit_ready_handler a handler given by the client's over service's communication component that calls the appropriate GNUnet
  * functions for message transmission.
+ * @param notify_transmit_ready_cancel_handler a handler given by the client's or service's communication component that cancels a transmission
+ * requested by the handler above.
  */
 void gnunet_search_communication_init(
-		void (*request_notify_transmit_ready_handler)(size_t size, void *cls, size_t (*)(void*, size_t, void*),
-				struct GNUNET_TIME_Relative)) {
+		void *(*request_notify_transmit_ready_handler)(void *session_cls, size_t size, void *cls,
+				size_t (*)(void*, size_t, void*), struct GNUNET_TIME_Relative),
+		void (*notify_transmit_ready_cancel_handler)(void *transmit_handle)) {
 	gnunet_search_communication_listeners = array_list_construct();
-	gnunet_search_communication_message_queue = queue_construct();
 	gnunet_search_communication_request_notify_transmit_ready = request_notify_transmit_ready_handler;
+	gnunet_search_communication_notify_transmit_ready_cancel = notify_transmit_ready_cancel_handler;
 }
 
 /**
- * @brief This function releases all resources held by the communication component.
+ * @brief This function releases all resources held by the communication component; all sessions have to be freed before.
  */
 void gnunet_search_communication_free() {
-	while(queue_get_length(gnunet_search_communication_message_queue)) {
-		struct gnunet_search_communication_queued_message *msg =
-				(struct gnunet_search_communication_queued_message *) queue_dequeue(
-						gnunet_search_communication_message_queue);
-		GNUNET_free(msg->buffer);
-		GNUNET_free(msg);
-	}
-	queue_free(gnunet_search_communication_message_queue);
 	array_list_free(gnunet_search_communication_listeners);
+	gnunet_search_pool_free();
+}
+
+/**
+ * @brief This function creates a new communication session.
+ *
+ * @param cls the closure of the session; it is passed to the transmission handler and to the listeners in order to identify the connection.
+ *
+ * @return a reference to the new session
+ */
+struct gnunet_search_communication_session *gnunet_search_communication_session_create(void *cls) {
+	struct gnunet_search_communication_session *session = (struct gnunet_search_communication_session*) GNUNET_malloc(
+			sizeof(struct gnunet_search_communication_session));
+	session->cls = cls;
+	session->message_queue = queue_construct();
+	session->transmitting = NULL;
+	session->transmit_handle = NULL;
+	session->transmit_task = GNUNET_SCHEDULER_NO_TASK;
+	session->transmit_timeout_task = GNUNET_SCHEDULER_NO_TASK;
+	session->fragments = queue_construct();
+	return session;
 }
 
 /**
- * @brief This function resets all active communication sessions.
+ * @brief This function frees a communication session including all messages not yet sent and all fragments received.
+ *
+ * @param session the session to free
+ */
+void gnunet_search_communication_session_free(struct gnunet_search_communication_session *session) {
+	gnunet_search_communication_session_flush(session);
+	if(session->transmit_task != GNUNET_SCHEDULER_NO_TASK)
+		GNUNET_SCHEDULER_cancel(session->transmit_task);
+	if(session->transmit_timeout_task != GNUNET_SCHEDULER_NO_TASK)
+		GNUNET_SCHEDULER_cancel(session->transmit_timeout_task);
+	if(session->transmit_handle)
+		gnunet_search_communication_notify_transmit_ready_cancel(session->transmit_handle);
+	if(session->transmitting)
+		gnunet_search_communication_queued_message_release(session->transmitting);
+	queue_free(session->message_queue);
+	queue_free(session->fragments);
+	GNUNET_free(session);
+}
+
+/**
+ * @brief This function resets a communication session.
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This function resets all active communication sessions. It is used to cope with a client or service disconnect; in that case
+ * This function resets a communication session. It is used to cope with a client or service disconnect; in that case
  * already received message fragments are no longer valid and all outgoing messages not yet sent have to be discarded.
+ *
+ * @param session the session to reset
  */
-void gnunet_search_communication_flush() {
-	while(queue_get_length(gnunet_search_communication_message_queue)) {
-		struct gnunet_search_communication_queued_message *msg =
-				(struct gnunet_search_communication_queued_message *) queue_dequeue(
-						gnunet_search_communication_message_queue);
-		GNUNET_free(msg->buffer);
-		GNUNET_free(msg);
-	}
-	gnunet_search_communication_receive(NULL);
+void gnunet_search_communication_session_flush(struct gnunet_search_communication_session *session) {
+	while(queue_get_length(session->message_queue))
+		gnunet_search_communication_queued_message_release(
+				(struct gnunet_search_communication_queued_message *) queue_dequeue(session->message_queue));
+	gnunet_search_communication_receive(session, NULL);
 }
 
 /**
@@ -253,25 +385,26 @@ void gnunet_search_communication_flush() {
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
  * This function handles the reception of a new GNUnet message that may be a fragment of a communication message. For this purpose
- * the function stores a fragment queue using a static variable. A new message contains a fragmentation header that indicates whether
+ * the session stores a fragment queue. A new message contains a fragmentation header that indicates whether
  * the message is fragmented and whether the current fragment is the last fragment. In case the current fragment is the last fragment
  * or the message is not fragmented it is assembled and passed to registered message handlers.
  *
+ * @param session the session the message has been received on
  * @param gnunet_message the GNUnet messag received; a NULL reference resets the fragment queue.
  *
  * @return a boolean value indicating whether more fragments are needed (1) for the communication message or not (0)
  */
-char gnunet_search_communication_receive(const struct GNUNET_MessageHeader *gnunet_message) {
-	static queue_t *fragments = NULL;
+char gnunet_search_communication_receive(struct gnunet_search_communication_session *session,
+		const struct GNUNET_MessageHeader *gnunet_message) {
+	queue_t *fragments = session->fragments;
 	/*
 	 * Todo Security - how many fragments?
 	 */
 	if(!gnunet_message) {
-		if(fragments)
-			while(queue_get_length(fragments)) {
-				void *fragment = (void*)queue_dequeue(fragments);
-				free(fragment);
-			}
+		while(queue_get_length(fragments)) {
+			void *fragment = (void*)queue_dequeue(fragments);
+			gnunet_search_pool_release(fragment);
+		}
 		return 0;
 	}
 
@@ -281,19 +414,13 @@ char gnunet_search_communication_receive(const struct GNUNET_MessageHeader *gnun
 
 	GNUNET_assert(gnunet_message_size >= sizeof(struct GNUNET_MessageHeader) + sizeof(struct message_header));
 	if(gnunet_message_size < sizeof(struct GNUNET_MessageHeader) + sizeof(struct message_header)) {
-		return gnunet_search_communication_receive(NULL);
+		return gnunet_search_communication_receive(session, NULL);
 	}
 
 	size_t payload_size = gnunet_message_size - sizeof(struct GNUNET_MessageHeader) - sizeof(struct message_header);
 
 	if(msg_header->flags & GNUNET_MESSAGE_SEARCH_FLAG_FRAGMENTED) {
-		if(!fragments)
-			fragments = queue_construct();
 		if(msg_header->flags & GNUNET_MESSAGE_SEARCH_FLAG_LAST_FRAGMENT) {
-//			struct gnunet_search_server_communication_header *header =
-//					(struct gnunet_search_server_communication_header*) malloc(
-//							sizeof(struct gnunet_search_server_communication_header));
-//			header->type = response->type;
 			size_t total_size;
 			char *buffer;
 			FILE *memstream = open_memstream(&buffer, &total_size);
@@ -305,37 +432,31 @@ char gnunet_search_communication_receive(const struct GNUNET_MessageHeader *gnun
 				size_t fragment_payload_size = fragment_message_size - sizeof(struct GNUNET_MessageHeader)
 						- sizeof(struct message_header);
 				fwrite(fragment_msg_header + 1, 1, fragment_payload_size, memstream);
-				GNUNET_free(fragment);
+				gnunet_search_pool_release(fragment);
 			}
 			fwrite(msg_header + 1, 1, payload_size, memstream);
 			fclose(memstream);
-			gnunet_search_communication_listeners_notify(total_size, buffer);
-//			free(header);
+			gnunet_search_communication_listeners_notify(session, total_size, buffer);
 			GNUNET_free(buffer);
 			return 0;
 		} else {
-			void *buffer = GNUNET_malloc(gnunet_message_size);
+			void *buffer = gnunet_search_pool_allocate(gnunet_message_size);
 			memcpy(buffer, gnunet_message, gnunet_message_size);
 			queue_enqueue(fragments, buffer);
 			return 1;
 		}
 	} else {
-//		struct gnunet_search_server_communication_header *header =
-//				(struct gnunet_search_server_communication_header*) malloc(
-//						sizeof(struct gnunet_search_server_communication_header));
-//		header->size = response->size;
-		gnunet_search_communication_listeners_notify(payload_size, msg_header + 1);
+		gnunet_search_communication_listeners_notify(session, payload_size, msg_header + 1);
 		return 0;
-//		free(header);
 	}
 }
 
 /**
  * @brief This function adds a new listener to be called on message arrival
  *
- * @param listener the new listener to add
+ * @param listener the new listener to add; it is passed the closure of the session the message has been received on.
  */
-void gnunet_search_communication_listener_add(void (*listener)(size_t, void*)) {
+void gnunet_search_communication_listener_add(void (*listener)(void*, size_t, void*)) {
 	array_list_insert(gnunet_search_communication_listeners, listener);
 }
 
@@ -345,13 +466,14 @@ void gnunet_search_communication_listener_add(void (*listener)(size_t, void*)) {
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
  * This function is used to transmit data from the service to the client or from the client to the service. For that purpose it
- * appends all necessary headers (the fragmentation and the GNUnet header) and queues the message in the output queue. In case
+ * appends all necessary headers (the fragmentation and the GNUnet header) and queues the message in the output queue of the session. In case
  * the message is too large for one GNUnet message it is fragmented. In the end a new task to send the message is created.
  *
+ * @param session the session to transmit the data on
  * @param data the data to be sent
  * @size the size of the data
  */
-void gnunet_search_communication_transmit(void *data, size_t size) {
+void gnunet_search_communication_transmit(struct gnunet_search_communication_session *session, void *data, size_t size) {
 	size_t maximal_payload_size = GNUNET_SERVER_MAX_MESSAGE_SIZE - sizeof(struct message_header)
 			- sizeof(struct GNUNET_MessageHeader);
 //	maximal_payload_size = 5;
@@ -372,7 +494,7 @@ void gnunet_search_communication_transmit(void *data, size_t size) {
 
 		size_t msg_with_header_size = sizeof(struct message_header) + size;
 
-		void *buffer = GNUNET_malloc(msg_with_header_size);
+		void *buffer = gnunet_search_pool_allocate(msg_with_header_size);
 		memcpy(buffer + sizeof(struct message_header), data + offset, size);
 
 		struct message_header *msg_header = (struct message_header*) buffer;
@@ -382,15 +504,15 @@ void gnunet_search_communication_transmit(void *data, size_t size) {
 		msg_header->flags = flags;
 
 		struct gnunet_search_communication_queued_message *msg =
-				(struct gnunet_search_communication_queued_message*) GNUNET_malloc(
+				(struct gnunet_search_communication_queued_message*) gnunet_search_pool_allocate(
 						sizeof(struct gnunet_search_communication_queued_message));
 		msg->buffer = buffer;
 		msg->size = msg_with_header_size;
 
-		queue_enqueue(gnunet_search_communication_message_queue, msg);
+		queue_enqueue(session->message_queue, msg);
 
 		data_left -= size;
 	}
 
-	GNUNET_SCHEDULER_add_delayed(GNUNET_TIME_UNIT_ZERO, &gnunet_search_communication_transmit_next, NULL);
+	gnunet_search_communication_transmit_schedule(session);
 }
@@ -29,13 +29,20 @@
 #include <gnunet/platform.h>
 #include <gnunet/gnunet_util_lib.h>
 
+struct gnunet_search_communication_session;
+
 extern void gnunet_search_communication_init(
-		void (*request_notify_transmit_ready_handler)(size_t size, void *cls, size_t (*)(void*, size_t, void*),
-				struct GNUNET_TIME_Relative));
-extern char gnunet_search_communication_receive(const struct GNUNET_MessageHeader *gnunet_message);
-extern void gnunet_search_communication_transmit(void *data, size_t size);
-extern void gnunet_search_communication_listener_add(void (*listener)(size_t, void*));
+		void *(*request_notify_transmit_ready_handler)(void *session_cls, size_t size, void *cls,
+				size_t (*)(void*, size_t, void*), struct GNUNET_TIME_Relative),
+		void (*notify_transmit_ready_cancel_handler)(void *transmit_handle));
 extern void gnunet_search_communication_free();
-extern void gnunet_search_communication_flush();
+extern struct gnunet_search_communication_session *gnunet_search_communication_session_create(void *cls);
+extern void gnunet_search_communication_session_free(struct gnunet_search_communication_session *session);
+extern void gnunet_search_communication_session_flush(struct gnunet_search_communication_session *session);
+extern char gnunet_search_communication_receive(struct gnunet_search_communication_session *session,
+		const struct GNUNET_MessageHeader *gnunet_message);
+extern void gnunet_search_communication_transmit(struct gnunet_search_communication_session *session, void *data,
+		size_t size);
+extern void gnunet_search_communication_listener_add(void (*listener)(void*, size_t, void*));
 
 #endif /* COMMUNICATION_H_ */
@@ -0,0 +1,152 @@
+/**
+ * @file search/communication/pool.c
+ * @author Julian Kranz
+ * @date 18.10.2026
+ *
+ * @brief This file contains all functions pertaining to the GNUnet Search buffer pool.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This file contains all functions pertaining to the GNUnet Search buffer pool. The pool is used for message buffers and output queue entries
+ * which are allocated and released at a high rate. The block sizes are rounded up to powers of two (size classes); a released block is kept
+ * in a free list of its size class and handed out again by the next allocation of that class. The number of blocks kept per class is bounded;
+ * in steady state the pool thus neither calls the allocator nor grows. Blocks larger than the largest size class are allocated directly.
+ */
+/*
+ *  This file is part of GNUnet Search.
+ *
+ *  GNUnet Search is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  GNUnet Search is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNUnet Search.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <gnunet/platform.h>
+#include <gnunet/gnunet_util_lib.h>
+
+#include "pool.h"
+
+/**
+ * @brief This constant defines the binary logarithm of the smallest size class.
+ */
+#define GNUNET_SEARCH_POOL_CLASS_SHIFT_MINIMUM 6
+/**
+ * @brief This constant defines the number of size classes; the largest class holds blocks of 128 KiB, enough for any GNUnet message.
+ */
+#define GNUNET_SEARCH_POOL_CLASSES 12
+/**
+ * @brief This constant defines the maximal number of released blocks kept per size class.
+ */
+#define GNUNET_SEARCH_POOL_CLASS_CACHE_SIZE 64
+
+/**
+ * @brief This data structure represents the header of a block; the usable memory follows the header.
+ */
+struct gnunet_search_pool_block {
+	/**
+	 * @brief This member stores a reference to the next released block of the same size class; it is only valid while the block is released.
+	 */
+	struct gnunet_search_pool_block *next;
+	/**
+	 * @brief This member stores the size class of the block; blocks allocated directly use the number of size classes.
+	 */
+	size_t size_class;
+};
+
+/**
+ * @brief This variable stores the free lists of the size classes.
+ */
+static struct gnunet_search_pool_block *gnunet_search_pool_free_lists[GNUNET_SEARCH_POOL_CLASSES];
+/**
+ * @brief This variable stores the number of blocks contained in the free lists of the size classes.
+ */
+static unsigned int gnunet_search_pool_free_lengths[GNUNET_SEARCH_POOL_CLASSES];
+
+/**
+ * @brief This function computes the size class of a block.
+ *
+ * @param size the size of the block including its header
+ *
+ * @return the size class or GNUNET_SEARCH_POOL_CLASSES in case the block is larger than the largest size class
+ */
+static size_t gnunet_search_pool_size_class_get(size_t size) {
+	size_t size_class = 0;
+	while(size_class < GNUNET_SEARCH_POOL_CLASSES
+			&& ((size_t) 1 << (size_class + GNUNET_SEARCH_POOL_CLASS_SHIFT_MINIMUM)) < size)
+		size_class++;
+	return size_class;
+}
+
+/**
+ * @brief This function allocates a block.
+ *
+ * @param size the size of the block
+ *
+ * @return a reference to the block; the block has to be released using the function below.
+ */
+void *gnunet_search_pool_allocate(size_t size) {
+	size_t size_class = gnunet_search_pool_size_class_get(sizeof(struct gnunet_search_pool_block) + size);
+
+	struct gnunet_search_pool_block *block;
+	if(size_class < GNUNET_SEARCH_POOL_CLASSES && gnunet_search_pool_free_lists[size_class]) {
+		block = gnunet_search_pool_free_lists[size_class];
+		gnunet_search_pool_free_lists[size_class] = block->next;
+		gnunet_search_pool_free_lengths[size_class]--;
+	} else if(size_class < GNUNET_SEARCH_POOL_CLASSES)
+		block = (struct gnunet_search_pool_block*) GNUNET_malloc(
+				(size_t) 1 << (size_class + GNUNET_SEARCH_POOL_CLASS_SHIFT_MINIMUM));
+	else
+		block = (struct gnunet_search_pool_block*) GNUNET_malloc(sizeof(struct gnunet_search_pool_block) + size);
+	block->next = NULL;
+	block->size_class = size_class;
+
+	return block + 1;
+}
+
+/**
+ * @brief This function releases a block allocated using the function above; the block is kept for reuse unless the free list of its size class is full.
+ *
+ * @param block the block to release; it may be NULL.
+ */
+void gnunet_search_pool_release(void *block) {
+	if(!block)
+		return;
+
+	struct gnunet_search_pool_block *header = (struct gnunet_search_pool_block*) block - 1;
+	if(header->size_class >= GNUNET_SEARCH_POOL_CLASSES
+			|| gnunet_search_pool_free_lengths[header->size_class] >= GNUNET_SEARCH_POOL_CLASS_CACHE_SIZE) {
+		GNUNET_free(header);
+		return;
+	}
+
+	header->next = gnunet_search_pool_free_lists[header->size_class];
+	gnunet_search_pool_free_lists[header->size_class] = header;
+	gnunet_search_pool_free_lengths[header->size_class]++;
+}
+
+/**
+ * @brief This function frees all blocks kept for reuse.
+ */
+void gnunet_search_pool_free() {
+	for(size_t size_class = 0; size_class < GNUNET_SEARCH_POOL_CLASSES; ++size_class) {
+		while(gnunet_search_pool_free_lists[size_class]) {
+			struct gnunet_search_pool_block *block = gnunet_search_pool_free_lists[size_class];
+			gnunet_search_pool_free_lists[size_class] = block->next;
+			GNUNET_free(block);
+		}
+		gnunet_search_pool_free_lengths[size_class] = 0;
+	}
+}
@@ -0,0 +1,176 @@
+/**
+ * @file search/service/block/plugin_block_search.c
+ * @author Julian Kranz
+ * @date 18.10.2026
+ *
+ * @brief This file contains the GNUnet block plugin for the block types of GNUnet Search.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This file contains the GNUnet block plugin for the block types of GNUnet Search. The DHT service only stores and returns blocks of types
+ * a plugin is loaded for; the plugin checks URL records and keyword postings (see the dht component) and suppresses duplicate replies using
+ * the Bloom filter of the request. The key of an URL record is the hash of its URL; the key of a keyword posting cannot be derived from the
+ * posting. The plugin has to be installed into the plugin directory of the GNUnet installation.
+ */
+/*
+ *  This file is part of GNUnet Search.
+ *
+ *  GNUnet Search is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  GNUnet Search is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNUnet Search.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <gnunet/platform.h>
+#include <gnunet/gnunet_util_lib.h>
+#include <gnunet/gnunet_block_plugin.h>
+
+#include "gnunet_protocols_search.h"
+#include "../dht/dht.h"
+
+/**
+ * @brief This constant defines the number of bits set in the Bloom filter of a request for each reply.
+ */
+#define GNUNET_SEARCH_BLOCK_BLOOMFILTER_K 16
+
+/**
+ * @brief This function checks whether a block is a well-formed block of one of the GNUnet Search block types.
+ *
+ * @param type the block type
+ * @param block the block
+ * @param block_size the size of the block
+ *
+ * @return a boolean value indicating whether the block is well-formed (1) or not (0)
+ */
+static char gnunet_search_block_valid(enum GNUNET_BLOCK_Type type, void const *block, size_t block_size) {
+	switch((int) type) {
+		case GNUNET_BLOCK_TYPE_SEARCH_URL: {
+			struct gnunet_search_dht_url_record record;
+			if(block_size < sizeof(struct gnunet_search_dht_url_record))
+				return 0;
+			memcpy(&record, block, sizeof(struct gnunet_search_dht_url_record));
+			size_t url_length = ntohs(record.url_length);
+			return url_length && block_size == sizeof(struct gnunet_search_dht_url_record) + url_length;
+		}
+		case GNUNET_BLOCK_TYPE_SEARCH_KEYWORD: {
+			char const *url = (char const*) block;
+			return block_size > 1 && !url[block_size - 1] && strlen(url) == block_size - 1;
+		}
+		default:
+			return 0;
+	}
+}
+
+/**
+ * @brief This function evaluates a request or a reply of one of the GNUnet Search block types.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function evaluates a request or a reply of one of the GNUnet Search block types. Requests must not carry an extended query. A reply
+ * is checked for being well-formed; replies already contained in the Bloom filter of the request are reported as duplicates, all others are
+ * added to the filter. Any number of replies may exist for a key.
+ *
+ * @param cls the plugin closure (not used)
+ * @param type the block type
+ * @param query the original query (hash)
+ * @param bf the Bloom filter of the request; the function may create it.
+ * @param bf_mutator the mutator to apply to the hashes added to the Bloom filter
+ * @param xquery the extended query
+ * @param xquery_size the size of the extended query
+ * @param reply_block the reply; it is NULL in case only the request is to be evaluated.
+ * @param reply_block_size the size of the reply
+ *
+ * @return the result of the evaluation
+ */
+static enum GNUNET_BLOCK_EvaluationResult gnunet_search_block_evaluate(void *cls, enum GNUNET_BLOCK_Type type,
+		const GNUNET_HashCode *query, struct GNUNET_CONTAINER_BloomFilter **bf, int32_t bf_mutator, const void *xquery,
+		size_t xquery_size, const void *reply_block, size_t reply_block_size) {
+	if(type != GNUNET_BLOCK_TYPE_SEARCH_URL && type != GNUNET_BLOCK_TYPE_SEARCH_KEYWORD)
+		return GNUNET_BLOCK_EVALUATION_TYPE_NOT_SUPPORTED;
+	if(xquery_size)
+		return GNUNET_BLOCK_EVALUATION_REQUEST_INVALID;
+	if(!reply_block)
+		return GNUNET_BLOCK_EVALUATION_REQUEST_VALID;
+	if(!gnunet_search_block_valid(type, reply_block, reply_block_size))
+		return GNUNET_BLOCK_EVALUATION_RESULT_INVALID;
+
+	if(bf) {
+		GNUNET_HashCode reply_hash;
+		GNUNET_HashCode mingled_hash;
+		GNUNET_CRYPTO_hash(reply_block, reply_block_size, &reply_hash);
+		GNUNET_BLOCK_mingle_hash(&reply_hash, bf_mutator, &mingled_hash);
+		if(*bf) {
+			if(GNUNET_CONTAINER_bloomfilter_test(*bf, &mingled_hash) == GNUNET_YES)
+				return GNUNET_BLOCK_EVALUATION_OK_DUPLICATE;
+		} else
+			*bf = GNUNET_CONTAINER_bloomfilter_init(NULL, 8, GNUNET_SEARCH_BLOCK_BLOOMFILTER_K);
+		GNUNET_CONTAINER_bloomfilter_add(*bf, &mingled_hash);
+	}
+	return GNUNET_BLOCK_EVALUATION_OK_MORE;
+}
+
+/**
+ * @brief This function derives the key of a block of one of the GNUnet Search block types.
+ *
+ * @param cls the plugin closure (not used)
+ * @param type the block type
+ * @param block the block
+ * @param block_size the size of the block
+ * @param key a reference to the memory to store the key in
+ *
+ * @return GNUNET_OK on success, GNUNET_NO in case the key cannot be derived from the block and GNUNET_SYSERR in case the block is malformed
+ * or of an unsupported type
+ */
+static int gnunet_search_block_get_key(void *cls, enum GNUNET_BLOCK_Type type, const void *block, size_t block_size,
+		GNUNET_HashCode *key) {
+	if(!gnunet_search_block_valid(type, block, block_size))
+		return GNUNET_SYSERR;
+	if(type != GNUNET_BLOCK_TYPE_SEARCH_URL)
+		return GNUNET_NO;
+
+	struct gnunet_search_dht_url_record const *record = (struct gnunet_search_dht_url_record const*) block;
+	GNUNET_CRYPTO_hash(record + 1, block_size - sizeof(struct gnunet_search_dht_url_record), key);
+	return GNUNET_OK;
+}
+
+/**
+ * @brief This function is the entry point of the plugin.
+ *
+ * @param cls the plugin closure (not used)
+ *
+ * @return the plugin functions
+ */
+void *libgnunet_plugin_block_search_init(void *cls) {
+	static enum GNUNET_BLOCK_Type types[] = { GNUNET_BLOCK_TYPE_SEARCH_URL, GNUNET_BLOCK_TYPE_SEARCH_KEYWORD,
+			GNUNET_BLOCK_TYPE_ANY };
+
+	struct GNUNET_BLOCK_PluginFunctions *api = (struct GNUNET_BLOCK_PluginFunctions*) GNUNET_malloc(
+			sizeof(struct GNUNET_BLOCK_PluginFunctions));
+	api->evaluate = &gnunet_search_block_evaluate;
+	api->get_key = &gnunet_search_block_get_key;
+	api->types = types;
+	return api;
+}
+
+/**
+ * @brief This function is the exit point of the plugin.
+ *
+ * @param cls the plugin functions returned by the entry point
+ *
+ * @return NULL
+ */
+void *libgnunet_plugin_block_search_done(void *cls) {
+	struct GNUNET_BLOCK_PluginFunctions *api = (struct GNUNET_BLOCK_PluginFunctions*) cls;
+	GNUNET_free(api);
+	return NULL;
+}
@@ -8,7 +8,9 @@
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
  * This file contains all functions pertaining to the GNUnet Search service's client communication component. This component is responsible for the communication
- * with the client. It uses the generic communication component and handles all service-specific elements.
+ * with the clients. It uses the generic communication component and handles all service-specific elements. Any number of clients may be connected at the
+ * same time; every client has a context of its own containing its communication session and its outstanding requests. The outstanding requests of all
+ * clients are kept in a hash map keyed by their flow id in order to route results to them.
  */
 /*
  *  This file is part of GNUnet Search.
@@ -43,71 +45,507 @@
 #include "../flooding/flooding.h"
 #include "../url-processor/url-processor.h"
 #include "../normalization/normalization.h"
+#include "../globals/globals.h"
+#include "../storage/storage.h"
 #include "client-communication.h"
 
 /**
- * @brief This variable stores a reference to the client the service is communicating with.
+ * @brief This constant defines the default time after which an outstanding search request is completed; a client may choose another deadline for a request.
+ */
+#define GNUNET_SEARCH_CLIENT_COMMUNICATION_REQUEST_TIMEOUT_DEFAULT GNUNET_TIME_relative_multiply(GNUNET_TIME_UNIT_MINUTES, 2)
+
+struct gnunet_search_client_communication_client_context;
+
+/**
+ * @brief This data structure represents an outstanding search request of a client; it maps the request id to a flow id.
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This variable stores a reference to the client the service is communicating with. It is important to note that the service can only communicate with one client
- * at a time.
+ * This data structure represents an outstanding search request of a client; it maps the request id to a flow id. The request id is used by the client
+ * to map a response to a specific request. In case such a request is a search request another id is created for the flooding. That id is called the flow id as it identifies
+ * one flow across different routers. Every answer to a flooded request will contain that flow id. On arrival of such a answer the flow id has to be mapped back to the corresponding
+ * request id in order to enable the service to create an appropriate answer for the client. A request is completed once the number of results requested by the
+ * client has been delivered, once its deadline has passed or once the client cancels it; the client is sent a done response in all cases.
  */
-static struct GNUNET_SERVER_Client *gnunet_search_client_communication_client;
+struct gnunet_search_client_communication_request {
+	/**
+	 * @brief This member stores a reference to the previous request of the client.
+	 */
+	struct gnunet_search_client_communication_request *prev;
+	/**
+	 * @brief This member stores a reference to the next request of the client.
+	 */
+	struct gnunet_search_client_communication_request *next;
+	/**
+	 * @brief This member stores a reference to the context of the client the request belongs to.
+	 */
+	struct gnunet_search_client_communication_client_context *context;
+	/**
+	 * @brief This member stores the request id to map.
+	 */
+	uint16_t request_id;
+	/**
+	 * @brief This member stores the flow id the request id is mapped to.
+	 */
+	uint64_t flow_id;
+	/**
+	 * @brief This member stores the forwarding strategy requested by the client.
+	 */
+	uint8_t forwarding;
+	/**
+	 * @brief This member stores the fanout of the forwarding strategy requested by the client.
+	 */
+	uint8_t fanout;
+	/**
+	 * @brief This member stores the maximal number of results requested by the client; 0 means no limit.
+	 */
+	uint16_t max_results;
+	/**
+	 * @brief This member stores the number of results delivered to the client so far.
+	 */
+	uint32_t results;
+	/**
+	 * @brief This member stores the task completing the request once it times out.
+	 */
+	GNUNET_SCHEDULER_TaskIdentifier timeout_task;
+};
 
 /**
- * @brief This constant defines the amount of time (measured in requests) the server keeps track of mappings between request and flow ids.
+ * @brief This data structure represents the context of a connected client.
  */
-#define GNUNET_SEARCH_CLIENT_COMMUNICATION_MAPPINGS_SIZE 15
+struct gnunet_search_client_communication_client_context {
+	/**
+	 * @brief This member stores a reference to the previous client context.
+	 */
+	struct gnunet_search_client_communication_client_context *prev;
+	/**
+	 * @brief This member stores a reference to the next client context.
+	 */
+	struct gnunet_search_client_communication_client_context *next;
+	/**
+	 * @brief This member stores a reference to the GNUnet client.
+	 */
+	struct GNUNET_SERVER_Client *client;
+	/**
+	 * @brief This member stores a reference to the communication session of the client; it owns the fragment reassembly and the output queue.
+	 */
+	struct gnunet_search_communication_session *session;
+	/**
+	 * @brief This member stores a reference to the first outstanding request of the client.
+	 */
+	struct gnunet_search_client_communication_request *requests_head;
+	/**
+	 * @brief This member stores a reference to the last outstanding request of the client.
+	 */
+	struct gnunet_search_client_communication_request *requests_tail;
+};
+
+/**
+ * @brief This variable stores a reference to the head of the list of client contexts.
+ */
+static struct gnunet_search_client_communication_client_context *gnunet_search_client_communication_clients_head;
+/**
+ * @brief This variable stores a reference to the tail of the list of client contexts.
+ */
+static struct gnunet_search_client_communication_client_context *gnunet_search_client_communication_clients_tail;
 /**
- * @brief This data structure is used to map a request id to a flow id.
+ * @brief This variable stores the client contexts keyed by the hash of the address of their GNUnet client.
  */
-struct gnunet_search_client_communication_message_mapping {
+static struct GNUNET_CONTAINER_MultiHashMap *gnunet_search_client_communication_clients;
+/**
+ * @brief This variable stores all outstanding requests keyed by the hash of their flow id; several requests may share a flow.
+ */
+static struct GNUNET_CONTAINER_MultiHashMap *gnunet_search_client_communication_requests;
+/**
+ * @brief This variable stores the time after which an outstanding search request is completed unless the client chooses another deadline.
+ */
+static struct GNUNET_TIME_Relative gnunet_search_client_communication_request_timeout;
+
+/**
+ * @brief This constant defines the default time window in which identical search requests are coalesced into a single flow.
+ */
+#define GNUNET_SEARCH_CLIENT_COMMUNICATION_QUERY_WINDOW_DEFAULT GNUNET_TIME_relative_multiply(GNUNET_TIME_UNIT_SECONDS, 10)
+/**
+ * @brief This constant defines the default maximal number of results kept for an in-flight query.
+ */
+#define GNUNET_SEARCH_CLIENT_COMMUNICATION_QUERY_RESULTS_MAX_DEFAULT 256
+
+/**
+ * @brief This data structure represents a result received for an in-flight query; the result data follows the structure.
+ */
+struct gnunet_search_client_communication_result {
 	/**
-	 * @brief This member stores the request id to map.
+	 * @brief This member stores a reference to the previous result of the query.
 	 */
-	uint16_t request_id;
+	struct gnunet_search_client_communication_result *prev;
 	/**
-	 * @brief This member stores the flow id the request id is mapped to.
+	 * @brief This member stores a reference to the next result of the query.
+	 */
+	struct gnunet_search_client_communication_result *next;
+	/**
+	 * @brief This member stores the size of the result data.
+	 */
+	size_t size;
+};
+
+/**
+ * @brief This data structure represents an in-flight query.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This data structure represents an in-flight query. Search requests for the same normalized keyword, forwarding strategy, fanout and result limit
+ * issued within the coalescing window are attached to the flow of the first request instead of starting a DHT lookup and a flooding of their own.
+ * The results received so far are kept (up to a configurable number) in order to deliver them to requests attached later.
+ */
+struct gnunet_search_client_communication_query {
+	/**
+	 * @brief This member stores a reference to the previous in-flight query.
+	 */
+	struct gnunet_search_client_communication_query *prev;
+	/**
+	 * @brief This member stores a reference to the next in-flight query.
+	 */
+	struct gnunet_search_client_communication_query *next;
+	/**
+	 * @brief This member stores the hash of the normalized keyword, the forwarding strategy, the fanout and the result limit (see below).
+	 */
+	GNUNET_HashCode key;
+	/**
+	 * @brief This member stores the flow id of the query.
 	 */
 	uint64_t flow_id;
+	/**
+	 * @brief This member stores a reference to the first result received for the query.
+	 */
+	struct gnunet_search_client_communication_result *results_head;
+	/**
+	 * @brief This member stores a reference to the last result received for the query.
+	 */
+	struct gnunet_search_client_communication_result *results_tail;
+	/**
+	 * @brief This member stores the number of results kept for the query.
+	 */
+	unsigned int results_length;
+	/**
+	 * @brief This member stores the task ending the coalescing window of the query.
+	 */
+	GNUNET_SCHEDULER_TaskIdentifier task;
 };
+
+/**
+ * @brief This variable stores a reference to the head of the list of in-flight queries.
+ */
+static struct gnunet_search_client_communication_query *gnunet_search_client_communication_queries_head;
+/**
+ * @brief This variable stores a reference to the tail of the list of in-flight queries.
+ */
+static struct gnunet_search_client_communication_query *gnunet_search_client_communication_queries_tail;
+/**
+ * @brief This variable stores the in-flight queries keyed by the hash of their normalized keyword, forwarding strategy, fanout and result limit.
+ */
+static struct GNUNET_CONTAINER_MultiHashMap *gnunet_search_client_communication_queries;
+/**
+ * @brief This variable stores the in-flight queries keyed by the hash of their flow id.
+ */
+static struct GNUNET_CONTAINER_MultiHashMap *gnunet_search_client_communication_queries_by_flow;
+/**
+ * @brief This variable stores the time window in which identical search requests are coalesced.
+ */
+static struct GNUNET_TIME_Relative gnunet_search_client_communication_query_window;
+/**
+ * @brief This variable stores the maximal number of results kept for an in-flight query.
+ */
+static unsigned int gnunet_search_client_communication_query_results_max;
+
+/**
+ * @brief This function computes the key used to look up an in-flight query by its flow id.
+ *
+ * @param flow_id the flow id
+ * @param key a reference to the memory to store the key in
+ */
+static void gnunet_search_client_communication_flow_key_get(uint64_t flow_id, GNUNET_HashCode *key) {
+	GNUNET_CRYPTO_hash(&flow_id, sizeof(flow_id), key);
+}
+
 /**
- * @brief This variable stores a reference to the mapping table used for translating between flow and request id.
+ * @brief This function computes the key used to look up an in-flight query.
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This variable stores a reference to the mapping table used for translating between flow and request id. The request id is used by the client
- * to map a response to a specific request. In case such a request is a search request another id is created for the flooding. That id is called the flow id as it identifies
- * one flow across different routers. Every answer to a flooded request will contain that flow id. On arrival of such a answer the flow id has to be mapped back to the corresponding
- * request id in order to enable the service to create an appropriate answer for the client.
+ * This function computes the key used to look up an in-flight query. Besides the normalized keyword the key covers the forwarding strategy, the
+ * fanout and the result limit since a flow is only forwarded in one way and stops at the limit of its request; requests asking for another
+ * strategy or limit are not coalesced.
+ *
+ * @param keyword the normalized keyword
+ * @param forwarding the forwarding strategy
+ * @param fanout the fanout of the forwarding strategy
+ * @param max_results the result limit; 0 means no limit.
+ * @param key a reference to the memory to store the key in
+ */
+static void gnunet_search_client_communication_query_key_get(char const *keyword, uint8_t forwarding, uint8_t fanout,
+		uint16_t max_results, GNUNET_HashCode *key) {
+	size_t keyword_length = strlen(keyword);
+	uint8_t *data = (uint8_t*) GNUNET_malloc(keyword_length + 4);
+	memcpy(data, keyword, keyword_length);
+	data[keyword_length] = forwarding;
+	data[keyword_length + 1] = fanout;
+	data[keyword_length + 2] = max_results >> 8;
+	data[keyword_length + 3] = max_results & 0xFF;
+	GNUNET_CRYPTO_hash(data, keyword_length + 4, key);
+	GNUNET_free(data);
+}
+
+/**
+ * @brief This function frees an in-flight query including its results.
+ *
+ * @param query the query to free
  */
-static struct gnunet_search_client_communication_message_mapping *gnunet_search_client_communication_mappings;
+static void gnunet_search_client_communication_query_free(struct gnunet_search_client_communication_query *query) {
+	if(query->task != GNUNET_SCHEDULER_NO_TASK)
+		GNUNET_SCHEDULER_cancel(query->task);
+
+	GNUNET_HashCode flow_key;
+	gnunet_search_client_communication_flow_key_get(query->flow_id, &flow_key);
+	GNUNET_CONTAINER_multihashmap_remove(gnunet_search_client_communication_queries_by_flow, &flow_key, query);
+	GNUNET_CONTAINER_multihashmap_remove(gnunet_search_client_communication_queries, &query->key, query);
+	GNUNET_CONTAINER_DLL_remove(gnunet_search_client_communication_queries_head,
+			gnunet_search_client_communication_queries_tail, query);
+
+	while(query->results_head) {
+		struct gnunet_search_client_communication_result *result = query->results_head;
+		GNUNET_CONTAINER_DLL_remove(query->results_head, query->results_tail, result);
+		GNUNET_free(result);
+	}
+	GNUNET_free(query);
+}
+
 /**
- * @brief This variable stores the current length of the mapping table introduced above.
+ * @brief This function ends the coalescing window of an in-flight query.
+ *
+ * @param cls the GNUnet closure containing a reference to the query
+ * @param tc the GNUnet task context (not used)
  */
-static size_t gnunet_search_client_communication_mappings_length;
+static void gnunet_search_client_communication_query_expire(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc) {
+	struct gnunet_search_client_communication_query *query = (struct gnunet_search_client_communication_query*) cls;
+	query->task = GNUNET_SCHEDULER_NO_TASK;
+	gnunet_search_client_communication_query_free(query);
+}
+
 /**
- * @brief This variable defines the next index to be overwritten in case a new mapping needs to be added to the table.
+ * @brief This function sends a result generated by the service back to a client.
+ *
+ * @param context the context of the client
+ * @param data the data to send to the client
+ * @param size the size of the data
+ * @param the request id to use for the response
+ */
+static void gnunet_search_client_communication_send_result(struct gnunet_search_client_communication_client_context *context,
+		void const *data, size_t size, char type, uint16_t id) {
+	size_t message_size = sizeof(struct search_response) + size;
+	void *message_buffer = GNUNET_malloc(message_size);
+
+	struct search_response *response = (struct search_response*) message_buffer;
+	response->type = type;
+	response->size = message_size;
+	response->id = id;
+
+	memcpy(response + 1, data, size);
+
+	gnunet_search_communication_transmit(context->session, message_buffer, message_size);
+
+	GNUNET_free(message_buffer);
+}
+
+/**
+ * @brief This function releases a flow once no request is attached to it any longer.
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This variable defines the next index to be overwritten in case a new mapping needs to be added to the table. The tables implements a simple FIFO replacement strategy.
+ * This function releases a flow once no request is attached to it any longer. The flow is cancelled and the corresponding in-flight query is
+ * discarded since its flow no longer delivers results.
+ *
+ * @param flow_id the flow id
+ */
+static void gnunet_search_client_communication_flow_release(uint64_t flow_id) {
+	GNUNET_HashCode flow_key;
+	gnunet_search_client_communication_flow_key_get(flow_id, &flow_key);
+	if(GNUNET_CONTAINER_multihashmap_contains(gnunet_search_client_communication_requests, &flow_key))
+		return;
+
+	gnunet_search_flooding_flow_cancel(flow_id);
+	struct gnunet_search_client_communication_query *query =
+			(struct gnunet_search_client_communication_query*) GNUNET_CONTAINER_multihashmap_get(
+					gnunet_search_client_communication_queries_by_flow, &flow_key);
+	if(query)
+		gnunet_search_client_communication_query_free(query);
+}
+
+/**
+ * @brief This function completes an outstanding request.
+ *
+ * @param request the request to complete
+ * @param done_send a boolean value indicating whether the client is to be sent a done response (1) or not (0); the latter is used in case
+ * the client has disconnected.
+ */
+static void gnunet_search_client_communication_request_complete(struct gnunet_search_client_communication_request *request,
+		char done_send) {
+	if(request->timeout_task != GNUNET_SCHEDULER_NO_TASK)
+		GNUNET_SCHEDULER_cancel(request->timeout_task);
+
+	GNUNET_HashCode flow_key;
+	gnunet_search_client_communication_flow_key_get(request->flow_id, &flow_key);
+	GNUNET_CONTAINER_multihashmap_remove(gnunet_search_client_communication_requests, &flow_key, request);
+	GNUNET_CONTAINER_DLL_remove(request->context->requests_head, request->context->requests_tail, request);
+	GNUNET_STATISTICS_set(gnunet_search_globals_statistics, gettext_noop("# search requests outstanding"),
+			GNUNET_CONTAINER_multihashmap_size(gnunet_search_client_communication_requests), GNUNET_NO);
+
+	if(done_send)
+		gnunet_search_client_communication_send_result(request->context, NULL, 0, GNUNET_SEARCH_RESPONSE_TYPE_DONE,
+				request->request_id);
+
+	gnunet_search_client_communication_flow_release(request->flow_id);
+	GNUNET_free(request);
+}
+
+/**
+ * @brief This function completes an outstanding request once its deadline has passed.
+ *
+ * @param cls the GNUnet closure containing a reference to the request
+ * @param tc the GNUnet task context (not used)
+ */
+static void gnunet_search_client_communication_request_timeout_handle(void *cls,
+		const struct GNUNET_SCHEDULER_TaskContext *tc) {
+	struct gnunet_search_client_communication_request *request = (struct gnunet_search_client_communication_request*) cls;
+	request->timeout_task = GNUNET_SCHEDULER_NO_TASK;
+	GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# search requests timed out"), 1, GNUNET_NO);
+	gnunet_search_client_communication_request_complete(request, 1);
+}
+
+/**
+ * @brief This function adds an outstanding request of a client.
+ *
+ * @param context the client context
+ * @param request_id the request id
+ * @param flow_id the flow id
+ * @param forwarding the forwarding strategy requested by the client
+ * @param fanout the fanout of the forwarding strategy requested by the client
+ * @param max_results the maximal number of results requested by the client
+ * @param deadline the deadline of the request in milliseconds; 0 selects the configured timeout.
+ *
+ * @return a reference to the new request
  */
-static size_t gnunet_search_client_communication_mappings_index;
+static struct gnunet_search_client_communication_request *gnunet_search_client_communication_request_add(
+		struct gnunet_search_client_communication_client_context *context, uint16_t request_id, uint64_t flow_id,
+		uint8_t forwarding, uint8_t fanout, uint16_t max_results, uint32_t deadline) {
+	struct gnunet_search_client_communication_request *request =
+			(struct gnunet_search_client_communication_request*) GNUNET_malloc(
+					sizeof(struct gnunet_search_client_communication_request));
+	request->context = context;
+	request->flow_id = flow_id;
+	request->request_id = request_id;
+	request->forwarding = forwarding;
+	request->fanout = fanout;
+	request->max_results = max_results;
+	request->results = 0;
+	request->timeout_task = GNUNET_SCHEDULER_add_delayed(
+			deadline ?
+					GNUNET_TIME_relative_multiply(GNUNET_TIME_UNIT_MILLISECONDS, deadline) :
+					gnunet_search_client_communication_request_timeout,
+			&gnunet_search_client_communication_request_timeout_handle, request);
+
+	GNUNET_HashCode flow_key;
+	gnunet_search_client_communication_flow_key_get(flow_id, &flow_key);
+	GNUNET_CONTAINER_multihashmap_put(gnunet_search_client_communication_requests, &flow_key, request,
+			GNUNET_CONTAINER_MULTIHASHMAPOPTION_MULTIPLE);
+	GNUNET_CONTAINER_DLL_insert(context->requests_head, context->requests_tail, request);
+	GNUNET_STATISTICS_set(gnunet_search_globals_statistics, gettext_noop("# search requests outstanding"),
+			GNUNET_CONTAINER_multihashmap_size(gnunet_search_client_communication_requests), GNUNET_NO);
+
+	return request;
+}
+
+/**
+ * @brief This function delivers a result to the client of an outstanding request.
+ *
+ * @param request the request
+ * @param data the result data; it consists of zero terminated results.
+ * @param size the size of the result data
+ *
+ * @return a boolean value indicating whether the request has received all results requested (1) or not (0)
+ */
+static char gnunet_search_client_communication_request_result_deliver(
+		struct gnunet_search_client_communication_request *request, void const *data, size_t size) {
+	gnunet_search_client_communication_send_result(request->context, data, size, GNUNET_SEARCH_RESPONSE_TYPE_RESULT,
+			request->request_id);
+
+	char const *results = (char const*) data;
+	for(size_t i = 0; i < size; ++i)
+		if(!results[i])
+			request->results++;
+	return request->max_results && request->results >= request->max_results;
+}
 
 /**
  * @brief This function hands a keyword over to the flooding component to search for it.
  *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function hands a keyword over to the flooding component to search for it. It is used as the miss handler of a DHT keyword lookup
+ * and is thus only called in case the keyword cannot be found in the DHT. The request is forwarded using the forwarding strategy chosen by the
+ * client; in case the client limited the number of results the flood only asks for the results still missing after the delivery of the results
+ * found in the local storage. Those results are recorded for the flow; the same results received from other peers are thus discarded.
+ *
  * @param keyword the keyword to search for
  * @param flow_id the flow id to be used for the flow
  */
 static void gnunet_search_client_communication_flooding_process(char const *keyword, uint64_t flow_id) {
-	gnunet_search_flooding_peer_data_send(keyword, strlen(keyword) + 1, GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_REQUEST,
-			flow_id);
+	GNUNET_HashCode flow_key;
+	gnunet_search_client_communication_flow_key_get(flow_id, &flow_key);
+	struct gnunet_search_client_communication_request *request =
+			(struct gnunet_search_client_communication_request*) GNUNET_CONTAINER_multihashmap_get(
+					gnunet_search_client_communication_requests, &flow_key);
+	if(!request)
+		return;
+	uint16_t max_results = request->max_results ? (uint16_t) (request->max_results - request->results) : 0;
+	gnunet_search_flooding_peer_request_send(keyword, strlen(keyword) + 1, flow_id, request->forwarding,
+			request->fanout, max_results);
+
+	struct gnunet_search_client_communication_query *query =
+			(struct gnunet_search_client_communication_query*) GNUNET_CONTAINER_multihashmap_get(
+					gnunet_search_client_communication_queries_by_flow, &flow_key);
+	if(query)
+		for(struct gnunet_search_client_communication_result *result = query->results_head; result; result = result->next)
+			gnunet_search_flooding_flow_results_record(flow_id, result + 1, result->size);
 //	gnunet_search_flooding_peer_request_flood(keyword, strlen(keyword) + 1);
 }
 
+/**
+ * @brief This function delivers the results found for a keyword in the local storage to the requests of a flow.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function delivers the results found for a keyword in the local storage to the requests of a flow. The storage is queried directly instead of
+ * answering the flooded request of the flow; the local results thus reach the client before any message is sent to the network.
+ *
+ * @param keyword the normalized keyword
+ * @param flow_id the flow id
+ */
+static void gnunet_search_client_communication_local_results_send(char const *keyword, uint64_t flow_id) {
+	array_list_t *values = gnunet_search_storage_values_get(keyword);
+	if(!values)
+		return;
+
+	char *values_serialized;
+	size_t values_serialized_size = gnunet_search_storage_value_serialize(&values_serialized, values,
+			GNUNET_SEARCH_FLOODING_MESSAGE_MAXIMAL_PAYLOAD_SIZE);
+	if(values_serialized_size) {
+		GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# search requests answered locally"), 1,
+				GNUNET_NO);
+		gnunet_search_client_communication_flow_result_send(values_serialized, values_serialized_size, flow_id);
+	}
+	GNUNET_free(values_serialized);
+}
+
 //static char gnunet_search_client_uint64_t_compare(void *a, void *b) {
 //	uint64_t *_a = (uint64_t*) a;
 //	uint64_t *_b = (uint64_t*) b;
@@ -120,18 +558,25 @@ static void gnunet_search_client_communication_flooding_process(char const *keyw
 //}
 
 /**
- * @brief This function handles a message from the client.
+ * @brief This function handles a message from a client.
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
  * This function handles a message from the client. It is important to note that a message may be fragmented and thus consist of more than one GNUnet messages.
- * The function extracts the action id from the header initiates the execution of the corresponding code. It therefor either adds a given set of URLs or floods
- * a search request.
+ * The function extracts the action id from the header initiates the execution of the corresponding code. It therefor either adds a given set of URLs or
+ * looks up a keyword. The results found in the local storage are delivered to the client at once; unless they already satisfy the request the keyword
+ * is then looked up in the DHT and the search request is only flooded in case the DHT lookup does not yield any result. A search request for a keyword that
+ * is already in flight is attached to the existing flow; the results received so far are delivered immediately. A cancelled search request is completed
+ * at once; its flow is cancelled unless another request is attached to it.
  *
+ * @param session_cls the closure of the communication session the message has been received on; it is the context of the client.
  * @param size the total size of the message; the function has to make sure that this matches the expected size given in the message's header.
  * @param buffer the buffer containing the message
  */
-static void gnunet_search_client_message_handle(size_t size, void *buffer) {
+static void gnunet_search_client_message_handle(void *session_cls, size_t size, void *buffer) {
+	struct gnunet_search_client_communication_client_context *context =
+			(struct gnunet_search_client_communication_client_context*) session_cls;
+
 	GNUNET_assert(size >= sizeof(struct search_command));
 	if(size < sizeof(struct search_command))
 		return;
@@ -152,18 +597,53 @@ static void gnunet_search_client_message_handle(size_t size, void *buffer) {
 
 //		printf("Searching keyword: %s...\n", keyword);
 
-		uint64_t flow_id = ((uint64_t) rand() << 32) | rand();
-		gnunet_search_client_communication_mappings[gnunet_search_client_communication_mappings_index].flow_id =
-				flow_id;
-		gnunet_search_client_communication_mappings[gnunet_search_client_communication_mappings_index].request_id =
-				cmd->id;
-		gnunet_search_client_communication_mappings_index = (gnunet_search_client_communication_mappings_index + 1)
-				% GNUNET_SEARCH_CLIENT_COMMUNICATION_MAPPINGS_SIZE;
-		if(gnunet_search_client_communication_mappings_length < GNUNET_SEARCH_CLIENT_COMMUNICATION_MAPPINGS_SIZE)
-			gnunet_search_client_communication_mappings_length++;
-
-//		search_process(keyword);
-		gnunet_search_client_communication_flooding_process(keyword, flow_id);
+		GNUNET_HashCode key;
+		gnunet_search_client_communication_query_key_get(keyword, cmd->forwarding, cmd->fanout, cmd->max_results, &key);
+
+		struct gnunet_search_client_communication_query *query =
+				(struct gnunet_search_client_communication_query*) GNUNET_CONTAINER_multihashmap_get(
+						gnunet_search_client_communication_queries, &key);
+		if(query) {
+			GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# search requests coalesced"), 1,
+					GNUNET_NO);
+			struct gnunet_search_client_communication_request *request = gnunet_search_client_communication_request_add(
+					context, cmd->id, query->flow_id, cmd->forwarding, cmd->fanout, cmd->max_results, cmd->deadline);
+			for(struct gnunet_search_client_communication_result *result = query->results_head; result;
+					result = result->next)
+				if(gnunet_search_client_communication_request_result_deliver(request, result + 1, result->size)) {
+					gnunet_search_client_communication_request_complete(request, 1);
+					break;
+				}
+		} else {
+			uint64_t flow_id = gnunet_search_flooding_flow_id_generate();
+			gnunet_search_client_communication_request_add(context, cmd->id, flow_id, cmd->forwarding, cmd->fanout,
+					cmd->max_results, cmd->deadline);
+
+			query = (struct gnunet_search_client_communication_query*) GNUNET_malloc(
+					sizeof(struct gnunet_search_client_communication_query));
+			memcpy(&query->key, &key, sizeof(GNUNET_HashCode));
+			query->flow_id = flow_id;
+			query->results_head = NULL;
+			query->results_tail = NULL;
+			query->results_length = 0;
+			query->task = GNUNET_SCHEDULER_add_delayed(gnunet_search_client_communication_query_window,
+					&gnunet_search_client_communication_query_expire, query);
+			GNUNET_HashCode flow_key;
+			gnunet_search_client_communication_flow_key_get(flow_id, &flow_key);
+			GNUNET_CONTAINER_multihashmap_put(gnunet_search_client_communication_queries, &key, query,
+					GNUNET_CONTAINER_MULTIHASHMAPOPTION_UNIQUE_FAST);
+			GNUNET_CONTAINER_multihashmap_put(gnunet_search_client_communication_queries_by_flow, &flow_key, query,
+					GNUNET_CONTAINER_MULTIHASHMAPOPTION_UNIQUE_FAST);
+			GNUNET_CONTAINER_DLL_insert(gnunet_search_client_communication_queries_head,
+					gnunet_search_client_communication_queries_tail, query);
+
+			/*
+			 * The request may be completed by the local results; the query is freed in that case.
+			 */
+			gnunet_search_client_communication_local_results_send(keyword, flow_id);
+			if(GNUNET_CONTAINER_multihashmap_contains(gnunet_search_client_communication_requests, &flow_key))
+				gnunet_search_dht_keyword_lookup(keyword, flow_id, &gnunet_search_client_communication_flooding_process);
+		}
 
 		GNUNET_free(keyword);
 	}
@@ -173,12 +653,22 @@ static void gnunet_search_client_message_handle(size_t size, void *buffer) {
 
 		gnunet_search_dht_url_list_put(urls, urls_length, 2);
 
-		gnunet_search_client_communication_send_result(NULL, 0, GNUNET_SEARCH_RESPONSE_TYPE_DONE, cmd->id);
+		gnunet_search_client_communication_send_result(context, NULL, 0, GNUNET_SEARCH_RESPONSE_TYPE_DONE, cmd->id);
 
 		for(size_t i = 0; i < urls_length; ++i)
 			GNUNET_free(urls[i]);
 		GNUNET_free(urls);
 	}
+	if(cmd->action == GNUNET_SEARCH_ACTION_CANCEL) {
+		struct gnunet_search_client_communication_request *request = context->requests_head;
+		while(request && request->request_id != cmd->id)
+			request = request->next;
+		if(request) {
+			GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# search requests cancelled"), 1,
+					GNUNET_NO);
+			gnunet_search_client_communication_request_complete(request, 1);
+		}
+	}
 }
 
 /**
@@ -191,23 +681,126 @@ static void gnunet_search_client_message_handle(size_t size, void *buffer) {
  * API functions and data structures are offered. In order to nevertheless implement a generic communication component both the client and the
  * service have to implement their own generic handlers. These generic handlers then call the specific GNUnet API functions for transmission.
  *
+ * @session_cls the closure of the communication session; it is the context of the client to send the message to.
  * @size the size of the message
  * @cls the GNUnet closure for the GNUnet API call
  * @handler the function within the generic communication component that handles the message transmission
+ *
+ * @return the GNUnet transmit handle; it is NULL in case the transmission could not be requested.
  */
-static void gnunet_search_client_communication_request_notify_transmit_ready(size_t size, void *cls,
+static void *gnunet_search_client_communication_request_notify_transmit_ready(void *session_cls, size_t size, void *cls,
 		size_t (*handler)(void*, size_t, void*), struct GNUNET_TIME_Relative max_delay) {
-	GNUNET_SERVER_notify_transmit_ready(gnunet_search_client_communication_client, size, max_delay, handler, cls);
+	struct gnunet_search_client_communication_client_context *context =
+			(struct gnunet_search_client_communication_client_context*) session_cls;
+	return GNUNET_SERVER_notify_transmit_ready(context->client, size, max_delay, handler, cls);
+}
+
+/**
+ * @brief This function cancels a transmission requested using the function above.
+ *
+ * @param transmit_handle the GNUnet transmit handle
+ */
+static void gnunet_search_client_communication_notify_transmit_ready_cancel(void *transmit_handle) {
+	GNUNET_SERVER_notify_transmit_ready_cancel((struct GNUNET_SERVER_TransmitHandle*) transmit_handle);
+}
+
+/**
+ * @brief This function computes the key used to look up the context of a GNUnet client.
+ *
+ * @param client the GNUnet client
+ * @param key a reference to the memory to store the key in
+ */
+static void gnunet_search_client_communication_client_key_get(struct GNUNET_SERVER_Client const *client,
+		GNUNET_HashCode *key) {
+	GNUNET_CRYPTO_hash(&client, sizeof(client), key);
+}
+
+/**
+ * @brief This function looks up the context of a GNUnet client.
+ *
+ * @param client the GNUnet client
+ *
+ * @return a reference to the context or NULL in case the client is unknown
+ */
+static struct gnunet_search_client_communication_client_context *gnunet_search_client_communication_client_context_get(
+		struct GNUNET_SERVER_Client const *client) {
+	GNUNET_HashCode key;
+	gnunet_search_client_communication_client_key_get(client, &key);
+	return (struct gnunet_search_client_communication_client_context*) GNUNET_CONTAINER_multihashmap_get(
+			gnunet_search_client_communication_clients, &key);
+}
+
+/**
+ * @brief This function creates the context of a newly connected client.
+ *
+ * @param client the GNUnet client
+ *
+ * @return a reference to the new context
+ */
+static struct gnunet_search_client_communication_client_context *gnunet_search_client_communication_client_context_create(
+		struct GNUNET_SERVER_Client *client) {
+	struct gnunet_search_client_communication_client_context *context =
+			(struct gnunet_search_client_communication_client_context*) GNUNET_malloc(
+					sizeof(struct gnunet_search_client_communication_client_context));
+	GNUNET_SERVER_client_keep(client);
+	context->client = client;
+	context->session = gnunet_search_communication_session_create(context);
+	context->requests_head = NULL;
+	context->requests_tail = NULL;
+
+	GNUNET_HashCode key;
+	gnunet_search_client_communication_client_key_get(client, &key);
+	GNUNET_CONTAINER_multihashmap_put(gnunet_search_client_communication_clients, &key, context,
+			GNUNET_CONTAINER_MULTIHASHMAPOPTION_UNIQUE_FAST);
+	GNUNET_CONTAINER_DLL_insert(gnunet_search_client_communication_clients_head,
+			gnunet_search_client_communication_clients_tail, context);
+	GNUNET_STATISTICS_set(gnunet_search_globals_statistics, gettext_noop("# clients connected"),
+			GNUNET_CONTAINER_multihashmap_size(gnunet_search_client_communication_clients), GNUNET_NO);
+
+	return context;
+}
+
+/**
+ * @brief This function frees the context of a client.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function frees the context of a client. The outstanding requests of the client are completed; flows no longer used by another request are
+ * cancelled (see gnunet_search_client_communication_flow_release()). Messages not yet sent to the client and fragments received from it are discarded.
+ *
+ * @param context the context to free
+ */
+static void gnunet_search_client_communication_client_context_free(
+		struct gnunet_search_client_communication_client_context *context) {
+	while(context->requests_head)
+		gnunet_search_client_communication_request_complete(context->requests_head, 0);
+
+	GNUNET_HashCode key;
+	gnunet_search_client_communication_client_key_get(context->client, &key);
+	GNUNET_CONTAINER_multihashmap_remove(gnunet_search_client_communication_clients, &key, context);
+	GNUNET_CONTAINER_DLL_remove(gnunet_search_client_communication_clients_head,
+			gnunet_search_client_communication_clients_tail, context);
+	GNUNET_STATISTICS_set(gnunet_search_globals_statistics, gettext_noop("# clients connected"),
+			GNUNET_CONTAINER_multihashmap_size(gnunet_search_client_communication_clients), GNUNET_NO);
+
+	gnunet_search_communication_session_free(context->session);
+	GNUNET_SERVER_client_drop(context->client);
+	GNUNET_free(context);
 }
 
 /**
  * @brief This function handles the disconnection of a client.
  *
  * @param cls the GNUnet closure (NULL)
- * @param client identification of the disconnected client (not used since only one client is allowed to connect to the service at once here)
+ * @param client identification of the disconnected client; NULL in case the server is destroyed.
  */
 static void gnunet_search_client_communication_disconnect_handle(void *cls, struct GNUNET_SERVER_Client *client) {
-	gnunet_search_client_communication_flush();
+	if(!client)
+		return;
+	struct gnunet_search_client_communication_client_context *context =
+			gnunet_search_client_communication_client_context_get(client);
+	if(context)
+		gnunet_search_client_communication_client_context_free(context);
 }
 
 /**
@@ -216,20 +809,16 @@ static void gnunet_search_client_communication_disconnect_handle(void *cls, stru
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
  * This function handles the reception of a new GNUnet message from a client. It call a necessary GNUnet functions to acknowledge the reception
- * and then passes the message to the communication component. If a client connect while another client is already connected the request is
- * not processed.
+ * and then passes the message to the communication session of the client. The context of the client is created on reception of its first message.
  */
 void gnunet_search_client_communication_message_handle(void *cls, struct GNUNET_SERVER_Client *client,
 		const struct GNUNET_MessageHeader *gnunet_message) {
-	if(gnunet_search_client_communication_client == NULL || client == gnunet_search_client_communication_client) {
-		GNUNET_SERVER_receive_done(client, GNUNET_OK);
-		GNUNET_SERVER_client_keep(client);
-		gnunet_search_client_communication_client = client;
-		gnunet_search_communication_receive(gnunet_message);
-	} else {
-		GNUNET_SERVER_receive_done(client, GNUNET_NO);
-		printf("Debug: Client already connected, not accepting client connection (TODO: send error)!\n");
-	}
+	struct gnunet_search_client_communication_client_context *context =
+			gnunet_search_client_communication_client_context_get(client);
+	if(!context)
+		context = gnunet_search_client_communication_client_context_create(client);
+	GNUNET_SERVER_receive_done(client, GNUNET_OK);
+	gnunet_search_communication_receive(context->session, gnunet_message);
 }
 
 /**
@@ -238,13 +827,22 @@ void gnunet_search_client_communication_message_handle(void *cls, struct GNUNET_
  * @param server a reference to the GNUnet server object needed to add handlers
  */
 void gnunet_search_client_communication_init(struct GNUNET_SERVER_Handle *server) {
-	gnunet_search_client_communication_mappings =
-			(struct gnunet_search_client_communication_message_mapping*) GNUNET_malloc(
-					sizeof(struct gnunet_search_client_communication_message_mapping)
-					* GNUNET_SEARCH_CLIENT_COMMUNICATION_MAPPINGS_SIZE);
-	gnunet_search_client_communication_mappings_index = 0;
-	gnunet_search_client_communication_mappings_length = 0;
-	gnunet_search_communication_init(&gnunet_search_client_communication_request_notify_transmit_ready);
+	gnunet_search_client_communication_clients_head = NULL;
+	gnunet_search_client_communication_clients_tail = NULL;
+	gnunet_search_client_communication_clients = GNUNET_CONTAINER_multihashmap_create(16);
+	gnunet_search_client_communication_requests = GNUNET_CONTAINER_multihashmap_create(64);
+	gnunet_search_client_communication_request_timeout = gnunet_search_globals_config_time_get("REQUEST_TIMEOUT",
+			GNUNET_SEARCH_CLIENT_COMMUNICATION_REQUEST_TIMEOUT_DEFAULT);
+	gnunet_search_client_communication_queries_head = NULL;
+	gnunet_search_client_communication_queries_tail = NULL;
+	gnunet_search_client_communication_queries = GNUNET_CONTAINER_multihashmap_create(16);
+	gnunet_search_client_communication_queries_by_flow = GNUNET_CONTAINER_multihashmap_create(16);
+	gnunet_search_client_communication_query_window = gnunet_search_globals_config_time_get("QUERY_COALESCE_WINDOW",
+			GNUNET_SEARCH_CLIENT_COMMUNICATION_QUERY_WINDOW_DEFAULT);
+	gnunet_search_client_communication_query_results_max = (unsigned int) gnunet_search_globals_config_number_get(
+			"QUERY_RESULTS_MAX", GNUNET_SEARCH_CLIENT_COMMUNICATION_QUERY_RESULTS_MAX_DEFAULT);
+	gnunet_search_communication_init(&gnunet_search_client_communication_request_notify_transmit_ready,
+			&gnunet_search_client_communication_notify_transmit_ready_cancel);
 	gnunet_search_communication_listener_add(&gnunet_search_client_message_handle);
 
 	static const struct GNUNET_SERVER_MessageHandler handlers[] = { {
@@ -258,63 +856,97 @@ void gnunet_search_client_communication_init(struct GNUNET_SERVER_Handle *server
  * @brief This function releases all resources held by the client communication component.
  */
 void gnunet_search_client_communication_free() {
-	GNUNET_free(gnunet_search_client_communication_mappings);
+	while(gnunet_search_client_communication_clients_head)
+		gnunet_search_client_communication_client_context_free(gnunet_search_client_communication_clients_head);
+	GNUNET_CONTAINER_multihashmap_destroy(gnunet_search_client_communication_clients);
+	GNUNET_CONTAINER_multihashmap_destroy(gnunet_search_client_communication_requests);
+
+	while(gnunet_search_client_communication_queries_head)
+		gnunet_search_client_communication_query_free(gnunet_search_client_communication_queries_head);
+	GNUNET_CONTAINER_multihashmap_destroy(gnunet_search_client_communication_queries);
+	GNUNET_CONTAINER_multihashmap_destroy(gnunet_search_client_communication_queries_by_flow);
 
 	gnunet_search_communication_free();
 }
 
 /**
- * @brief This function resets all active communication sessions.
- *
- * \latexonly \\ \\ \endlatexonly
- * \em Detailed \em description \n
- * This function resets all active communication sessions. For this purpose it resets the id to flow id mappings table and flushes the
- * communication component.
+ * @brief This data structure is used as closure while delivering a result to the requests of a flow.
  */
-void gnunet_search_client_communication_flush() {
-	gnunet_search_client_communication_mappings_length = 0;
-	gnunet_search_client_communication_mappings_index = 0;
-	gnunet_search_client_communication_client = NULL;
-
-	gnunet_search_communication_flush();
-}
+struct gnunet_search_client_communication_result_delivery {
+	/**
+	 * @brief This member stores a reference to the result data.
+	 */
+	void const *data;
+	/**
+	 * @brief This member stores the size of the result data.
+	 */
+	size_t size;
+	/**
+	 * @brief This member stores the requests that have received all results requested; they are completed after the iteration.
+	 */
+	struct gnunet_search_client_communication_request **completed;
+	/**
+	 * @brief This member stores the number of completed requests.
+	 */
+	unsigned int completed_length;
+};
 
 /**
- * @brief This function sends a result generated by the service back to the client.
+ * @brief This function delivers a result to a request attached to a flow; it is used as hash map iterator.
  *
- * @param data the data to send to the client
- * @param size the size of the data
- * @param the request id to use for the response
+ * @param cls the delivery (see above)
+ * @param key the hash of the flow id (not used)
+ * @param value the request
+ *
+ * @return GNUNET_YES in order to continue the iteration
  */
-void gnunet_search_client_communication_send_result(void const *data, size_t size, char type, uint16_t id) {
-	size_t message_size = sizeof(struct search_response) + size;
-	void *message_buffer = GNUNET_malloc(message_size);
-
-	struct search_response *response = (struct search_response*) message_buffer;
-	response->type = type;
-	response->size = message_size;
-	response->id = id;
-
-	memcpy(response + 1, data, size);
-
-	gnunet_search_communication_transmit(message_buffer, message_size);
-
-	GNUNET_free(message_buffer);
+static int gnunet_search_client_communication_request_result_iterate(void *cls, const GNUNET_HashCode *key, void *value) {
+	struct gnunet_search_client_communication_result_delivery *delivery =
+			(struct gnunet_search_client_communication_result_delivery*) cls;
+	struct gnunet_search_client_communication_request *request = (struct gnunet_search_client_communication_request*) value;
+	if(gnunet_search_client_communication_request_result_deliver(request, delivery->data, delivery->size))
+		GNUNET_array_append(delivery->completed, delivery->completed_length, request);
+	return GNUNET_YES;
 }
 
 /**
- * @brief This function looks up a request id by a given flow id using the mappings table.
+ * @brief This function sends a result of a flow to all requests attached to the flow.
  *
- * @param flow_id the flow id to map
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function sends a result of a flow to all requests attached to the flow; they are looked up in the hash map of outstanding requests. In case
+ * the flow belongs to an in-flight query the result is also stored in order to deliver it to requests attached to the query later; once the maximal
+ * number of results is kept further results are only delivered to the requests already attached. Requests that have received all results requested
+ * are completed.
  *
- * @return the corresponding request id or zero in case it is not found
+ * @param data the result data
+ * @param size the size of the result data
+ * @param flow_id the flow id
  */
-uint16_t gnunet_search_client_communication_by_flow_id_request_id_get(uint64_t flow_id) {
-	uint16_t request_id = 0;
-	for(size_t i = 0; i < gnunet_search_client_communication_mappings_length; ++i)
-		if(gnunet_search_client_communication_mappings[i].flow_id == flow_id) {
-			request_id = gnunet_search_client_communication_mappings[i].request_id;
-			break;
-		}
-	return request_id;
+void gnunet_search_client_communication_flow_result_send(void const *data, size_t size, uint64_t flow_id) {
+	GNUNET_HashCode flow_key;
+	gnunet_search_client_communication_flow_key_get(flow_id, &flow_key);
+	struct gnunet_search_client_communication_query *query =
+			(struct gnunet_search_client_communication_query*) GNUNET_CONTAINER_multihashmap_get(
+					gnunet_search_client_communication_queries_by_flow, &flow_key);
+	if(query) {
+		if(query->results_length < gnunet_search_client_communication_query_results_max) {
+			struct gnunet_search_client_communication_result *result =
+					(struct gnunet_search_client_communication_result*) GNUNET_malloc(
+							sizeof(struct gnunet_search_client_communication_result) + size);
+			result->size = size;
+			memcpy(result + 1, data, size);
+			GNUNET_CONTAINER_DLL_insert_tail(query->results_head, query->results_tail, result);
+			query->results_length++;
+		} else
+			GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# query results not kept"), 1,
+					GNUNET_NO);
+	}
+
+	struct gnunet_search_client_communication_result_delivery delivery = { data, size, NULL, 0 };
+	GNUNET_CONTAINER_multihashmap_get_multiple(gnunet_search_client_communication_requests, &flow_key,
+			&gnunet_search_client_communication_request_result_iterate, &delivery);
+	for(unsigned int i = 0; i < delivery.completed_length; ++i)
+		gnunet_search_client_communication_request_complete(delivery.completed[i], 1);
+	GNUNET_free_non_null(delivery.completed);
 }
@@ -33,8 +33,6 @@ extern void gnunet_search_client_communication_message_handle(void *cls, struct
 		const struct GNUNET_MessageHeader *message);
 extern void gnunet_search_client_communication_init(struct GNUNET_SERVER_Handle *server);
 extern void gnunet_search_client_communication_free();
-extern void gnunet_search_client_communication_send_result(void const *data, size_t size, char type, uint16_t id);
-extern uint16_t gnunet_search_client_communication_by_flow_id_request_id_get(uint64_t flow_id);
-extern void gnunet_search_client_communication_flush();
+extern void gnunet_search_client_communication_flow_result_send(void const *data, size_t size, uint64_t flow_id);
 
 #endif /* CLIENT_COMMUNICATION_H_ */
@@ -0,0 +1,184 @@
+/**
+ * @file search/service/compression/compression.c
+ * @author Julian Kranz
+ * @date 18.10.2026
+ *
+ * @brief This file contains all functions pertaining to the GNUnet Search service's compression component.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This file contains all functions pertaining to the GNUnet Search service's compression component. The component encodes the payload of
+ * flooding messages - lists of strings each terminated by a zero byte - in a compact form. The strings are sorted and front-coded, i.e. every
+ * string is stored as the length of the prefix it shares with the previous string followed by the remaining suffix; URLs of the same host thus
+ * only cost their distinct parts. The result is compressed using deflate. The encoded form consists of the size of the front-coded data (four
+ * bytes in network byte order) followed by the deflate stream. Since the strings are sorted the order of the strings is not preserved.
+ */
+/*
+ *  This file is part of GNUnet Search.
+ *
+ *  GNUnet Search is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  GNUnet Search is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNUnet Search.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <zlib.h>
+
+#include <gnunet/platform.h>
+#include <gnunet/gnunet_util_lib.h>
+
+#include "compression.h"
+
+/**
+ * @brief This constant defines the maximal length of a shared prefix; longer prefixes are truncated to this length.
+ */
+#define GNUNET_SEARCH_COMPRESSION_PREFIX_MAXIMUM UINT8_MAX
+
+/**
+ * @brief This function compares two strings referenced by array elements; it is used to sort the strings.
+ *
+ * @param a a reference to the first string
+ * @param b a reference to the second string
+ *
+ * @return the result of comparing the strings (see strcmp())
+ */
+static int gnunet_search_compression_string_compare(void const *a, void const *b) {
+	return strcmp(*(char const * const *) a, *(char const * const *) b);
+}
+
+/**
+ * @brief This function encodes a list of strings.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function encodes a list of strings (see above). The encoding is only used in case it is smaller than the original data; otherwise
+ * the function fails.
+ *
+ * @param data the list of strings; every string is terminated by a zero byte.
+ * @param data_size the size of the list
+ * @param encoded a reference to a variable the function stores the encoded data in; the caller has to free the data.
+ *
+ * @return the size of the encoded data or 0 in case the data is not a list of strings or the encoding does not save any space
+ */
+size_t gnunet_search_compression_encode(void const *data, size_t data_size, void **encoded) {
+	char const *strings = (char const*) data;
+	if(!data_size || strings[data_size - 1])
+		return 0;
+
+	size_t strings_length = 0;
+	for(size_t offset = 0; offset < data_size; offset += strlen(strings + offset) + 1)
+		strings_length++;
+	char const **sorted = (char const**) GNUNET_malloc(sizeof(char const*) * strings_length);
+	size_t index = 0;
+	for(size_t offset = 0; offset < data_size; offset += strlen(strings + offset) + 1)
+		sorted[index++] = strings + offset;
+	qsort(sorted, strings_length, sizeof(char const*), &gnunet_search_compression_string_compare);
+
+	uint8_t *front_coded = (uint8_t*) GNUNET_malloc(data_size + strings_length);
+	size_t front_coded_size = 0;
+	char const *previous = "";
+	for(size_t i = 0; i < strings_length; ++i) {
+		size_t shared = 0;
+		while(shared < GNUNET_SEARCH_COMPRESSION_PREFIX_MAXIMUM && previous[shared] && previous[shared] == sorted[i][shared])
+			shared++;
+		size_t suffix_size = strlen(sorted[i] + shared) + 1;
+		front_coded[front_coded_size++] = shared;
+		memcpy(front_coded + front_coded_size, sorted[i] + shared, suffix_size);
+		front_coded_size += suffix_size;
+		previous = sorted[i];
+	}
+	GNUNET_free(sorted);
+
+	uLongf deflated_size = compressBound(front_coded_size);
+	uint8_t *output = (uint8_t*) GNUNET_malloc(sizeof(uint32_t) + deflated_size);
+	if(compress2(output + sizeof(uint32_t), &deflated_size, front_coded, front_coded_size, Z_BEST_COMPRESSION) != Z_OK
+			|| sizeof(uint32_t) + deflated_size >= data_size) {
+		GNUNET_free(front_coded);
+		GNUNET_free(output);
+		return 0;
+	}
+	GNUNET_free(front_coded);
+
+	uint32_t front_coded_size_network = htonl(front_coded_size);
+	memcpy(output, &front_coded_size_network, sizeof(uint32_t));
+	*encoded = output;
+	return sizeof(uint32_t) + deflated_size;
+}
+
+/**
+ * @brief This function decodes a list of strings encoded by the function above.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function decodes a list of strings encoded by the function above. Since the encoded data is received from the network every size and
+ * prefix length is checked; malformed data as well as data decoding to more than the maximal size given is rejected.
+ *
+ * @param encoded the encoded data
+ * @param encoded_size the size of the encoded data
+ * @param data a reference to a variable the function stores the list of strings in; the caller has to free the list.
+ * @param maximal_size the maximal size of the list of strings
+ *
+ * @return the size of the list of strings or 0 in case the encoded data is invalid
+ */
+size_t gnunet_search_compression_decode(void const *encoded, size_t encoded_size, void **data, size_t maximal_size) {
+	if(encoded_size < sizeof(uint32_t))
+		return 0;
+	uint32_t front_coded_size_network;
+	memcpy(&front_coded_size_network, encoded, sizeof(uint32_t));
+	uLongf front_coded_size = ntohl(front_coded_size_network);
+	if(!front_coded_size || front_coded_size > 2 * maximal_size)
+		return 0;
+
+	uint8_t *front_coded = (uint8_t*) GNUNET_malloc(front_coded_size);
+	uLongf inflated_size = front_coded_size;
+	if(uncompress(front_coded, &inflated_size, (uint8_t const*) encoded + sizeof(uint32_t),
+			encoded_size - sizeof(uint32_t)) != Z_OK || inflated_size != front_coded_size) {
+		GNUNET_free(front_coded);
+		return 0;
+	}
+
+	char *output = (char*) GNUNET_malloc(maximal_size);
+	size_t output_size = 0;
+	size_t previous = 0;
+	size_t previous_length = 0;
+	for(size_t offset = 0; offset < front_coded_size;) {
+		size_t shared = front_coded[offset++];
+		uint8_t *terminator = (uint8_t*) memchr(front_coded + offset, 0, front_coded_size - offset);
+		if(!terminator || shared > previous_length) {
+			output_size = 0;
+			break;
+		}
+		size_t suffix_size = terminator - (front_coded + offset) + 1;
+		if(output_size + shared + suffix_size > maximal_size) {
+			output_size = 0;
+			break;
+		}
+		memmove(output + output_size, output + previous, shared);
+		memcpy(output + output_size + shared, front_coded + offset, suffix_size);
+		previous = output_size;
+		previous_length = shared + suffix_size - 1;
+		output_size += shared + suffix_size;
+		offset += suffix_size;
+	}
+	GNUNET_free(front_coded);
+
+	if(!output_size) {
+		GNUNET_free(output);
+		return 0;
+	}
+	*data = output;
+	return output_size;
+}
@@ -0,0 +1,35 @@
+/**
+ * @file search/service/compression/compression.h
+ * @author Julian Kranz
+ * @date 18.10.2026
+ *
+ * @brief This file defines all exported data structures, functions, constants and variables pertaining to
+ * the GNUnet Search service's compression component.
+ */
+/*
+ *  This file is part of GNUnet Search.
+ *
+ *  GNUnet Search is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  GNUnet Search is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNUnet Search.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPRESSION_H_
+#define COMPRESSION_H_
+
+#include <stdlib.h>
+
+extern size_t gnunet_search_compression_encode(void const *data, size_t data_size, void **encoded);
+extern size_t gnunet_search_compression_decode(void const *encoded, size_t encoded_size, void **data,
+		size_t maximal_size);
+
+#endif /* COMPRESSION_H_ */
@@ -34,8 +34,30 @@
 
 #include "dht.h"
 
+#include "gnunet_protocols_search.h"
 #include "../globals/globals.h"
 #include "../url-processor/url-processor.h"
+#include "../util/service-util.h"
+#include "../client-communication/client-communication.h"
+
+#include <collections/queue/queue.h>
+
+/**
+ * @brief This constant defines the default number of DHT puts the publish queue issues per second.
+ */
+#define GNUNET_SEARCH_DHT_PUBLISH_RATE_DEFAULT 10
+/**
+ * @brief This constant defines the default time window in which duplicate DHT puts are coalesced.
+ */
+#define GNUNET_SEARCH_DHT_PUBLISH_COALESCE_WINDOW_DEFAULT GNUNET_TIME_relative_multiply(GNUNET_TIME_UNIT_MINUTES, 10)
+/**
+ * @brief This constant defines the time GNUnet may take to hand a put over to the DHT service before the continuation is called anyway.
+ */
+#define GNUNET_SEARCH_DHT_PUBLISH_TIMEOUT GNUNET_TIME_UNIT_MINUTES
+/**
+ * @brief This constant defines the default time a keyword lookup waits for results from the DHT.
+ */
+#define GNUNET_SEARCH_DHT_LOOKUP_TIMEOUT_DEFAULT GNUNET_TIME_relative_multiply(GNUNET_TIME_UNIT_SECONDS, 2)
 
 /**
  * @brief This variable stores a reference to the GNUnet dht monitor handle.
@@ -46,76 +68,301 @@ static struct GNUNET_DHT_MonitorHandle *gnunet_search_dht_monitor_handle;
  */
 static struct GNUNET_DHT_Handle *gnunet_search_dht_handle;
 
-//static void search_dht_get_result_iterator_and_send_to_user(void *cls, struct GNUNET_TIME_Absolute exp,
-//		const GNUNET_HashCode * key, const struct GNUNET_PeerIdentity * get_path, unsigned int get_path_length,
-//		const struct GNUNET_PeerIdentity * put_path, unsigned int put_path_length, enum GNUNET_BLOCK_Type type,
-//		size_t size, const void *data) {
-//
-//	GNUNET_DHT_get_stop(dht_get_handle);
-//
-//	gnunet_search_client_communication_send_result(data, size, GNUNET_SEARCH_RESPONSE_TYPE_RESULT);
-//}
-//
-//static void search_dht_get_and_send_to_user(char const *keyword) {
-//	char *key_value;
-//	search_key_value_generate_simple(&key_value, "keyword", keyword);
-//
-//	printf("Searching for: %s\n", key_value);
-//
-//	GNUNET_HashCode hash;
-//	GNUNET_CRYPTO_hash(key_value, strlen(key_value), &hash);
-//
-//	free(key_value);
-//
-//	dht_get_handle = GNUNET_DHT_get_start(gnunet_search_dht_handle, GNUNET_BLOCK_TYPE_TEST, &hash, 3,
-//			GNUNET_DHT_RO_NONE, NULL, 0, &search_dht_get_result_iterator_and_send_to_user, NULL);
-//}
-//
-//static void search_process(char const *keyword) {
-//	search_dht_get_and_send_to_user(keyword);
-//}
-
-/**
- * @brief This function puts a key-value-tuple into the DHT; both the key and the value are strings.
- *
- * @param key the key of the tuple
- * @param value the value of the tuple
- */
-static void gnunet_search_dht_string_string_put(const char *key, const char *value) {
-	size_t key_length = strlen(key);
+/**
+ * @brief This data structure represents a DHT put waiting in the publish queue.
+ */
+struct gnunet_search_dht_publish_entry {
+	/**
+	 * @brief This member stores the GNUnet block type of the put.
+	 */
+	enum GNUNET_BLOCK_Type type;
+	/**
+	 * @brief This member stores the hashed key of the put.
+	 */
+	GNUNET_HashCode key;
+	/**
+	 * @brief This member stores a reference to the value of the put.
+	 */
+	void *value;
+	/**
+	 * @brief This member stores the size of the value.
+	 */
+	size_t value_size;
+	/**
+	 * @brief This member stores the time the put has been enqueued; it is used to measure the queueing latency.
+	 */
+	struct GNUNET_TIME_Absolute enqueued;
+};
 
-	GNUNET_HashCode hash;
-	GNUNET_CRYPTO_hash(key, key_length, &hash);
+/**
+ * @brief This variable implements the publish queue for DHT puts.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This variable implements the publish queue for DHT puts. Instead of handing every URL found by the crawler to the DHT service at
+ * once the puts are enqueued here and issued one after one; the next put is only scheduled from the continuation of the previous one
+ * and never earlier than the configured rate allows.
+ */
+static queue_t *gnunet_search_dht_publish_queue;
+/**
+ * @brief This variable stores all key-value-tuples published recently mapped to the time of their last publication; it is used to coalesce duplicate puts.
+ */
+static struct GNUNET_CONTAINER_MultiHashMap *gnunet_search_dht_publish_recent;
+/**
+ * @brief This variable stores the minimal interval between two puts derived from the configured rate.
+ */
+static struct GNUNET_TIME_Relative gnunet_search_dht_publish_interval;
+/**
+ * @brief This variable stores the time window in which duplicate puts are coalesced.
+ */
+static struct GNUNET_TIME_Relative gnunet_search_dht_publish_coalesce_window;
+/**
+ * @brief This variable stores the time the last put has been issued.
+ */
+static struct GNUNET_TIME_Absolute gnunet_search_dht_publish_last;
+/**
+ * @brief This variable stores a reference to the put currently handed over to the DHT service; it is NULL if no put is in flight.
+ */
+static struct gnunet_search_dht_publish_entry *gnunet_search_dht_publish_in_flight;
+/**
+ * @brief This variable stores the task scheduled to issue the next put.
+ */
+static GNUNET_SCHEDULER_TaskIdentifier gnunet_search_dht_publish_task;
+/**
+ * @brief This variable stores the task periodically removing outdated entries from the coalescing map.
+ */
+static GNUNET_SCHEDULER_TaskIdentifier gnunet_search_dht_publish_cleanup_task;
+
+/**
+ * @brief This data structure stores the state of a keyword lookup in the DHT.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This data structure stores the state of a keyword lookup in the DHT. A lookup is running until its timeout is reached; if no result
+ * has been found by then the miss handler is called in order to fall back to flooding the request.
+ */
+struct gnunet_search_dht_lookup {
+	/**
+	 * @brief This member stores a reference to the next lookup in the list of running lookups.
+	 */
+	struct gnunet_search_dht_lookup *next;
+	/**
+	 * @brief This member stores a reference to the previous lookup in the list of running lookups.
+	 */
+	struct gnunet_search_dht_lookup *prev;
+	/**
+	 * @brief This member stores a reference to the GNUnet DHT get handle.
+	 */
+	struct GNUNET_DHT_GetHandle *get_handle;
+	/**
+	 * @brief This member stores the task ending the lookup.
+	 */
+	GNUNET_SCHEDULER_TaskIdentifier timeout_task;
+	/**
+	 * @brief This member stores the flow id the results are delivered for.
+	 */
+	uint64_t flow_id;
+	/**
+	 * @brief This member stores a reference to the keyword searched for.
+	 */
+	char *keyword;
+	/**
+	 * @brief This member stores the number of results received so far.
+	 */
+	size_t results;
+	/**
+	 * @brief This member stores a reference to the function called in case the lookup does not yield any result.
+	 */
+	void (*miss_handler)(char const *keyword, uint64_t flow_id);
+};
+
+/**
+ * @brief This variable stores a reference to the head of the list of running lookups.
+ */
+static struct gnunet_search_dht_lookup *gnunet_search_dht_lookups_head;
+/**
+ * @brief This variable stores a reference to the tail of the list of running lookups.
+ */
+static struct gnunet_search_dht_lookup *gnunet_search_dht_lookups_tail;
+/**
+ * @brief This variable stores the time a keyword lookup waits for results before falling back to flooding.
+ */
+static struct GNUNET_TIME_Relative gnunet_search_dht_lookup_timeout;
+
+static void gnunet_search_dht_publish_next(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc);
+
+/**
+ * @brief This function frees an entry of the publish queue.
+ *
+ * @param entry the entry to free
+ */
+static void gnunet_search_dht_publish_entry_free(struct gnunet_search_dht_publish_entry *entry) {
+	GNUNET_free(entry->value);
+	GNUNET_free(entry);
+}
+
+/**
+ * @brief This function is the continuation called by GNUnet once a put has been handed over to the DHT service.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function is the continuation called by GNUnet once a put has been handed over to the DHT service. It updates the latency
+ * statistics, frees the put and schedules the next put of the queue; the delay is chosen such that the configured rate is not exceeded.
+ * If the component has already been released in the meantime only the put is freed.
+ *
+ * @param cls the GNUnet closure containing a reference to the put
+ * @param tc the GNUnet task context (not used)
+ */
+static void gnunet_search_dht_publish_done(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc) {
+	struct gnunet_search_dht_publish_entry *entry = (struct gnunet_search_dht_publish_entry*) cls;
+
+	GNUNET_STATISTICS_set(gnunet_search_globals_statistics, gettext_noop("DHT publish latency (ms)"),
+			GNUNET_TIME_absolute_get_duration(entry->enqueued).rel_value, GNUNET_NO);
 
-	size_t value_length = strlen(value);
+	gnunet_search_dht_publish_in_flight = NULL;
+	gnunet_search_dht_publish_entry_free(entry);
+
+	if(!gnunet_search_dht_publish_queue)
+		return;
+
+	struct GNUNET_TIME_Relative delay = GNUNET_TIME_absolute_get_remaining(
+			GNUNET_TIME_absolute_add(gnunet_search_dht_publish_last, gnunet_search_dht_publish_interval));
+	gnunet_search_dht_publish_task = GNUNET_SCHEDULER_add_delayed(delay, &gnunet_search_dht_publish_next, NULL);
+}
+
+/**
+ * @brief This function issues the next put waiting in the publish queue.
+ *
+ * @param cls the GNUnet closure (not used)
+ * @param tc the GNUnet task context (not used)
+ */
+static void gnunet_search_dht_publish_next(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc) {
+	gnunet_search_dht_publish_task = GNUNET_SCHEDULER_NO_TASK;
+
+	size_t queue_length = queue_get_length(gnunet_search_dht_publish_queue);
+	if(!queue_length)
+		return;
+
+	struct gnunet_search_dht_publish_entry *entry = (struct gnunet_search_dht_publish_entry*) queue_dequeue(
+			gnunet_search_dht_publish_queue);
+	GNUNET_STATISTICS_set(gnunet_search_globals_statistics, gettext_noop("# DHT publish queue length"),
+			queue_length - 1, GNUNET_NO);
+	GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# DHT puts issued"), 1, GNUNET_NO);
+
+	gnunet_search_dht_publish_last = GNUNET_TIME_absolute_get();
+	gnunet_search_dht_publish_in_flight = entry;
+
+	GNUNET_DHT_put(gnunet_search_dht_handle, &entry->key, 2, GNUNET_DHT_RO_NONE, entry->type,
+			entry->value_size, entry->value, GNUNET_TIME_absolute_get_forever_(), GNUNET_SEARCH_DHT_PUBLISH_TIMEOUT,
+			&gnunet_search_dht_publish_done, entry);
+}
+
+/**
+ * @brief This function tests whether a key-value-tuple has been published within the coalescing window and records the current publication.
+ *
+ * @param key the combined hash of the tuple to test
+ *
+ * @return a boolean value indicating whether the tuple has been published recently (1) or not (0)
+ */
+static char gnunet_search_dht_publish_recent_test_and_set(GNUNET_HashCode const *key) {
+	struct GNUNET_TIME_Absolute *published = (struct GNUNET_TIME_Absolute*) GNUNET_CONTAINER_multihashmap_get(
+			gnunet_search_dht_publish_recent, key);
+	if(published) {
+		if(GNUNET_TIME_absolute_get_duration(*published).rel_value
+				< gnunet_search_dht_publish_coalesce_window.rel_value)
+			return 1;
+	} else {
+		published = (struct GNUNET_TIME_Absolute*) GNUNET_malloc(sizeof(struct GNUNET_TIME_Absolute));
+		GNUNET_CONTAINER_multihashmap_put(gnunet_search_dht_publish_recent, key, published,
+				GNUNET_CONTAINER_MULTIHASHMAPOPTION_UNIQUE_FAST);
+	}
+	*published = GNUNET_TIME_absolute_get();
+	return 0;
+}
+
+/**
+ * @brief This function is the iteration handler used to remove outdated entries from the coalescing map.
+ *
+ * @param cls the GNUnet closure (not used)
+ * @param key the key of the current entry
+ * @param value the time of the last publication of the key
+ *
+ * @return GNUNET_YES in order to continue the iteration
+ */
+static int gnunet_search_dht_publish_recent_cleanup_iterator(void *cls, GNUNET_HashCode const *key, void *value) {
+	struct GNUNET_TIME_Absolute *published = (struct GNUNET_TIME_Absolute*) value;
+	if(GNUNET_TIME_absolute_get_duration(*published).rel_value >= gnunet_search_dht_publish_coalesce_window.rel_value) {
+		GNUNET_CONTAINER_multihashmap_remove(gnunet_search_dht_publish_recent, key, value);
+		GNUNET_free(published);
+	}
+	return GNUNET_YES;
+}
 
-	GNUNET_DHT_put(gnunet_search_dht_handle, &hash, 2, GNUNET_DHT_RO_NONE, GNUNET_BLOCK_TYPE_TEST, value_length + 1,
-			value, GNUNET_TIME_absolute_get_forever_(), GNUNET_TIME_relative_get_forever_(), /*&message_sent_cont*/NULL,
-			NULL);
+/**
+ * @brief This function periodically removes outdated entries from the coalescing map in order to keep its size bounded.
+ *
+ * @param cls the GNUnet closure (not used)
+ * @param tc the GNUnet task context (not used)
+ */
+static void gnunet_search_dht_publish_recent_cleanup(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc) {
+	GNUNET_CONTAINER_multihashmap_iterate(gnunet_search_dht_publish_recent,
+			&gnunet_search_dht_publish_recent_cleanup_iterator, NULL);
+	gnunet_search_dht_publish_cleanup_task = GNUNET_SCHEDULER_add_delayed(gnunet_search_dht_publish_coalesce_window,
+			&gnunet_search_dht_publish_recent_cleanup, NULL);
 }
 
 /**
- * @brief This function combines an action string, an integer parameter and a data string to a string used as a key or value in the DHT.
+ * @brief This function enqueues a block to be put into the DHT.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function enqueues a block to be put into the DHT. In case the same key-value-tuple has already been published within the
+ * coalescing window the put is dropped. If the publish queue is idle the transmission is started.
  *
- * @param key_value a reference to a string used to store the generated string in
- * @param action the action string to use
- * @param the integer parameter
- * @param data the data string
+ * @param type the GNUnet block type of the block
+ * @param key the hashed key of the block
+ * @param data the data of the block
+ * @param size the size of the data
  */
-static void gnunet_search_dht_key_value_generate(char **key_value, const char *action, unsigned int parameter,
-		const char *data) {
-	size_t key_value_length;
-	FILE *key_value_stream = open_memstream(key_value, &key_value_length);
+static void gnunet_search_dht_block_put(enum GNUNET_BLOCK_Type type, GNUNET_HashCode const *key, void const *data,
+		size_t size) {
+	GNUNET_HashCode value_hash;
+	GNUNET_CRYPTO_hash(data, size, &value_hash);
+	GNUNET_HashCode tuple_hash;
+	GNUNET_CRYPTO_hash_xor(key, &value_hash, &tuple_hash);
+
+	if(gnunet_search_dht_publish_recent_test_and_set(&tuple_hash)) {
+		GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# DHT puts coalesced"), 1,
+				GNUNET_NO);
+		return;
+	}
+
+	struct gnunet_search_dht_publish_entry *entry = (struct gnunet_search_dht_publish_entry*) GNUNET_malloc(
+			sizeof(struct gnunet_search_dht_publish_entry));
+	entry->type = type;
+	memcpy(&entry->key, key, sizeof(GNUNET_HashCode));
+	entry->value = GNUNET_malloc(size);
+	memcpy(entry->value, data, size);
+	entry->value_size = size;
+	entry->enqueued = GNUNET_TIME_absolute_get();
 
-	fprintf(key_value_stream, "search:%s:%u:%s", action, parameter, data);
-	fputc(0, key_value_stream);
+	queue_enqueue(gnunet_search_dht_publish_queue, entry);
+	GNUNET_STATISTICS_set(gnunet_search_globals_statistics, gettext_noop("# DHT publish queue length"),
+			queue_get_length(gnunet_search_dht_publish_queue), GNUNET_NO);
 
-	fclose(key_value_stream);
+	if(!gnunet_search_dht_publish_in_flight && gnunet_search_dht_publish_task == GNUNET_SCHEDULER_NO_TASK)
+		gnunet_search_dht_publish_task = GNUNET_SCHEDULER_add_now(&gnunet_search_dht_publish_next, NULL);
 }
 
 /**
  * @brief This function is the callback function handed to GNUnet to be called on a captured DHT put event.
  *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function is the callback function handed to GNUnet to be called on a captured DHT put event. The DHT service only reports puts
+ * of the URL record block type; the function decodes the record, verifies that it has been stored under the hash of its URL and passes
+ * the URL to the URL processor component.
+ *
  * @param cls the GNUnet closure (not used)
  * @param options the GNUnet DHT route options (not used)
  * @param type the GNUnet block type (not used)
@@ -124,7 +371,7 @@ static void gnunet_search_dht_key_value_generate(char **key_value, const char *a
  * @param path_length the path length (not used)
  * @param path the path (not used)
  * @param exp the expiration time of the data (not used)
- * @param key the hashed key (not used)
+ * @param key the hashed key
  * @param data the data inserted into the DHT
  * @param size the size of the data
  */
@@ -132,32 +379,192 @@ static void gnunet_search_dht_monitor_put(void *cls, enum GNUNET_DHT_RouteOption
 		uint32_t hop_count, uint32_t desired_replication_level, unsigned int path_length,
 		const struct GNUNET_PeerIdentity *path, struct GNUNET_TIME_Absolute exp, const GNUNET_HashCode * key,
 		const void *data, size_t size) {
-	char const *prefix = "search:url:";
-	size_t prefix_length = strlen(prefix);
-	if(size < prefix_length + 1)
+	/*
+	 * Security, data from network
+	 */
+	if(size < sizeof(struct gnunet_search_dht_url_record))
 		return;
-	if(!strncmp(prefix, data, prefix_length))
-		gnunet_search_url_processor_incoming_url_process(prefix_length, data, size);
+	struct gnunet_search_dht_url_record const *record = (struct gnunet_search_dht_url_record const*) data;
+	size_t url_length = ntohs(record->url_length);
+	if(!url_length || size != sizeof(struct gnunet_search_dht_url_record) + url_length)
+		return;
+
+	char const *url = (char const*) (record + 1);
+
+	GNUNET_HashCode url_hash;
+	GNUNET_CRYPTO_hash(url, url_length, &url_hash);
+	if(GNUNET_CRYPTO_hash_cmp(&url_hash, key))
+		return;
+
+	gnunet_search_url_processor_incoming_url_process(key, url, url_length, record->depth);
 }
 
 /**
  * @brief This function inserts an array of URLs into the DHT.
  *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function inserts an array of URLs into the DHT. Every URL is encoded as a binary URL record and stored under the hash of the URL
+ * using the URL record block type.
+ *
  * @param urls the array of URLs
  * @param size the number of URLs contained in the array
  * @parameter the parameter value to include (see URL processor component)
  */
 void gnunet_search_dht_url_list_put(char **urls, size_t size, unsigned int parameter) {
 	for(int i = 0; i < size; ++i) {
-		char *key_value;
-		gnunet_search_dht_key_value_generate(&key_value, "url", parameter, urls[i]);
+		size_t url_length = strlen(urls[i]);
+		if(!url_length || url_length > GNUNET_SEARCH_DHT_URL_RECORD_URL_MAXIMAL_LENGTH)
+			continue;
+
+		size_t record_size = sizeof(struct gnunet_search_dht_url_record) + url_length;
+		struct gnunet_search_dht_url_record *record = (struct gnunet_search_dht_url_record*) GNUNET_malloc(
+				record_size);
+		record->depth = (uint8_t) GNUNET_MIN(parameter, UINT8_MAX);
+		record->url_length = htons((uint16_t) url_length);
+		memcpy(record + 1, urls[i], url_length);
+
+		GNUNET_HashCode hash;
+		GNUNET_CRYPTO_hash(urls[i], url_length, &hash);
+
+		gnunet_search_dht_block_put(GNUNET_BLOCK_TYPE_SEARCH_URL, &hash, record, record_size);
+
+		GNUNET_free(record);
+	}
+}
+
+/**
+ * @brief This function inserts a keyword posting into the DHT.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function inserts a keyword posting into the DHT. The posting maps the normalized keyword to an URL it has been found on; it is
+ * stored under the hash of the "search:keyword:" prefixed keyword. Other peers are thus able to look up the keyword without flooding.
+ *
+ * @param keyword the normalized keyword
+ * @param url the URL the keyword has been found on
+ */
+void gnunet_search_dht_keyword_put(char const *keyword, char const *url) {
+	char *key;
+	gnunet_search_util_key_value_generate_simple(&key, "keyword", keyword);
+
+	GNUNET_HashCode hash;
+	GNUNET_CRYPTO_hash(key, strlen(key), &hash);
+
+	GNUNET_free(key);
 
-//		printf("Putting value %s...\n", key_value);
+	gnunet_search_dht_block_put(GNUNET_BLOCK_TYPE_SEARCH_KEYWORD, &hash, url, strlen(url) + 1);
+}
+
+/**
+ * @brief This function releases a keyword lookup and removes it from the list of running lookups.
+ *
+ * @param lookup the lookup to release
+ */
+static void gnunet_search_dht_lookup_free(struct gnunet_search_dht_lookup *lookup) {
+	GNUNET_CONTAINER_DLL_remove(gnunet_search_dht_lookups_head, gnunet_search_dht_lookups_tail, lookup);
+	if(lookup->timeout_task != GNUNET_SCHEDULER_NO_TASK)
+		GNUNET_SCHEDULER_cancel(lookup->timeout_task);
+	GNUNET_DHT_get_stop(lookup->get_handle);
+	GNUNET_free(lookup->keyword);
+	GNUNET_free(lookup);
+}
+
+/**
+ * @brief This function is the iteration handler called by GNUnet for every result of a keyword lookup.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function is the iteration handler called by GNUnet for every result of a keyword lookup. Every result is a posting containing
+ * an URL; it is delivered to the client using the client communication component.
+ *
+ * @param cls the GNUnet closure containing a reference to the lookup
+ * @param exp the expiration time of the result (not used)
+ * @param key the hashed key (not used)
+ * @param get_path the path of the get request (not used)
+ * @param get_path_length the length of the get path (not used)
+ * @param put_path the path of the put request (not used)
+ * @param put_path_length the length of the put path (not used)
+ * @param type the GNUnet block type (not used)
+ * @param size the size of the result
+ * @param data the result
+ */
+static void gnunet_search_dht_lookup_result_iterator(void *cls, struct GNUNET_TIME_Absolute exp,
+		const GNUNET_HashCode * key, const struct GNUNET_PeerIdentity * get_path, unsigned int get_path_length,
+		const struct GNUNET_PeerIdentity * put_path, unsigned int put_path_length, enum GNUNET_BLOCK_Type type,
+		size_t size, const void *data) {
+	struct gnunet_search_dht_lookup *lookup = (struct gnunet_search_dht_lookup*) cls;
+
+	/*
+	 * Security, data from network
+	 */
+	if(!size || ((char const*) data)[size - 1])
+		return;
+
+	lookup->results++;
+
+	gnunet_search_client_communication_flow_result_send(data, size, lookup->flow_id);
+}
 
-		gnunet_search_dht_string_string_put(key_value, key_value);
+/**
+ * @brief This function ends a keyword lookup after its timeout; if no result has been found it calls the lookup's miss handler.
+ *
+ * @param cls the GNUnet closure containing a reference to the lookup
+ * @param tc the GNUnet task context (not used)
+ */
+static void gnunet_search_dht_lookup_timeout_task(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc) {
+	struct gnunet_search_dht_lookup *lookup = (struct gnunet_search_dht_lookup*) cls;
+	lookup->timeout_task = GNUNET_SCHEDULER_NO_TASK;
 
-		GNUNET_free(key_value);
+	if(lookup->results)
+		GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# DHT keyword lookups hit"), 1,
+				GNUNET_NO);
+	else {
+		GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# DHT keyword lookups missed"), 1,
+				GNUNET_NO);
+		lookup->miss_handler(lookup->keyword, lookup->flow_id);
 	}
+
+	gnunet_search_dht_lookup_free(lookup);
+}
+
+/**
+ * @brief This function looks up a keyword in the DHT.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function looks up a keyword in the DHT. All postings found are delivered to the client as results of the given flow. In case
+ * no posting is found within the lookup timeout the miss handler is called; it is used to fall back to flooding the request.
+ *
+ * @param keyword the normalized keyword to look up
+ * @param flow_id the flow id the results belong to
+ * @param miss_handler the function to call in case the lookup does not yield any result
+ */
+void gnunet_search_dht_keyword_lookup(char const *keyword, uint64_t flow_id,
+		void (*miss_handler)(char const *keyword, uint64_t flow_id)) {
+	char *key;
+	gnunet_search_util_key_value_generate_simple(&key, "keyword", keyword);
+
+	GNUNET_HashCode hash;
+	GNUNET_CRYPTO_hash(key, strlen(key), &hash);
+
+	GNUNET_free(key);
+
+	size_t keyword_length = strlen(keyword);
+
+	struct gnunet_search_dht_lookup *lookup = (struct gnunet_search_dht_lookup*) GNUNET_malloc(
+			sizeof(struct gnunet_search_dht_lookup));
+	lookup->flow_id = flow_id;
+	lookup->keyword = (char*) GNUNET_malloc(keyword_length + 1);
+	memcpy(lookup->keyword, keyword, keyword_length + 1);
+	lookup->results = 0;
+	lookup->miss_handler = miss_handler;
+	GNUNET_CONTAINER_DLL_insert(gnunet_search_dht_lookups_head, gnunet_search_dht_lookups_tail, lookup);
+
+	lookup->get_handle = GNUNET_DHT_get_start(gnunet_search_dht_handle, GNUNET_BLOCK_TYPE_SEARCH_KEYWORD, &hash, 3,
+			GNUNET_DHT_RO_NONE, NULL, 0, &gnunet_search_dht_lookup_result_iterator, lookup);
+	lookup->timeout_task = GNUNET_SCHEDULER_add_delayed(gnunet_search_dht_lookup_timeout,
+			&gnunet_search_dht_lookup_timeout_task, lookup);
 }
 
 /**
@@ -166,11 +573,30 @@ void gnunet_search_dht_url_list_put(char **urls, size_t size, unsigned int param
 void gnunet_search_dht_init() {
 	gnunet_search_dht_handle = GNUNET_DHT_connect(gnunet_search_globals_cfg, 3);
 
+	gnunet_search_dht_publish_queue = queue_construct();
+	gnunet_search_dht_publish_recent = GNUNET_CONTAINER_multihashmap_create(256);
+	gnunet_search_dht_publish_interval = GNUNET_TIME_relative_divide(GNUNET_TIME_UNIT_SECONDS,
+			GNUNET_MAX(1, gnunet_search_globals_config_number_get("DHT_PUBLISH_RATE",
+					GNUNET_SEARCH_DHT_PUBLISH_RATE_DEFAULT)));
+	gnunet_search_dht_publish_coalesce_window = gnunet_search_globals_config_time_get("DHT_PUBLISH_COALESCE_WINDOW",
+			GNUNET_SEARCH_DHT_PUBLISH_COALESCE_WINDOW_DEFAULT);
+	gnunet_search_dht_publish_last = GNUNET_TIME_absolute_get();
+	gnunet_search_dht_publish_in_flight = NULL;
+	gnunet_search_dht_publish_task = GNUNET_SCHEDULER_NO_TASK;
+	gnunet_search_dht_publish_cleanup_task = GNUNET_SCHEDULER_add_delayed(gnunet_search_dht_publish_coalesce_window,
+			&gnunet_search_dht_publish_recent_cleanup, NULL);
+
+	gnunet_search_dht_lookups_head = NULL;
+	gnunet_search_dht_lookups_tail = NULL;
+	gnunet_search_dht_lookup_timeout = gnunet_search_globals_config_time_get("DHT_LOOKUP_TIMEOUT",
+			GNUNET_SEARCH_DHT_LOOKUP_TIMEOUT_DEFAULT);
+
 	/*
-	 * Todo: Own block type
+	 * URL records are stored under the hash of their URL; since there is no common key the monitor is restricted by the block type
+	 * only. The DHT service applies that filter itself so no foreign traffic reaches the put handler.
 	 */
-	gnunet_search_dht_monitor_handle = GNUNET_DHT_monitor_start(gnunet_search_dht_handle, GNUNET_BLOCK_TYPE_TEST, NULL, NULL, NULL,
-			&gnunet_search_dht_monitor_put, NULL);
+	gnunet_search_dht_monitor_handle = GNUNET_DHT_monitor_start(gnunet_search_dht_handle, GNUNET_BLOCK_TYPE_SEARCH_URL, NULL,
+			NULL, NULL, &gnunet_search_dht_monitor_put, NULL);
 }
 
 /**
@@ -178,11 +604,33 @@ void gnunet_search_dht_init() {
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This function releases all resources held by the dht component. It stops to monitor the DHT and disconnects from the DHT service.
+ * This function releases all resources held by the dht component. It stops to monitor the DHT, cancels all running keyword lookups,
+ * discards all puts still waiting in the publish queue and disconnects from the DHT service.
  */
 void gnunet_search_dht_free() {
 	GNUNET_DHT_monitor_stop(gnunet_search_dht_monitor_handle);
 
+	while(gnunet_search_dht_lookups_head)
+		gnunet_search_dht_lookup_free(gnunet_search_dht_lookups_head);
+
+	if(gnunet_search_dht_publish_task != GNUNET_SCHEDULER_NO_TASK)
+		GNUNET_SCHEDULER_cancel(gnunet_search_dht_publish_task);
+	GNUNET_SCHEDULER_cancel(gnunet_search_dht_publish_cleanup_task);
+
+	while(queue_get_length(gnunet_search_dht_publish_queue))
+		gnunet_search_dht_publish_entry_free(
+				(struct gnunet_search_dht_publish_entry*) queue_dequeue(gnunet_search_dht_publish_queue));
+	queue_free(gnunet_search_dht_publish_queue);
+	gnunet_search_dht_publish_queue = NULL;
+
+	gnunet_search_dht_publish_coalesce_window = GNUNET_TIME_UNIT_ZERO;
+	GNUNET_CONTAINER_multihashmap_iterate(gnunet_search_dht_publish_recent,
+			&gnunet_search_dht_publish_recent_cleanup_iterator, NULL);
+	GNUNET_CONTAINER_multihashmap_destroy(gnunet_search_dht_publish_recent);
+
+	/*
+	 * The put in flight (if any) is still owned by the DHT API; it is freed by its continuation.
+	 */
 	GNUNET_DHT_disconnect(gnunet_search_dht_handle);
 }
 
@@ -30,7 +30,36 @@
 #include <gnunet/gnunet_util_lib.h>
 #include <gnunet/gnunet_dht_service.h>
 
+#include "gnunet_protocols_search.h"
+
+/**
+ * @brief This constant defines the maximal length of an URL that can be encoded in an URL record.
+ */
+#define GNUNET_SEARCH_DHT_URL_RECORD_URL_MAXIMAL_LENGTH (GNUNET_SERVER_MAX_MESSAGE_SIZE / 2)
+
+/**
+ * @brief This data structure defines the header of an URL record stored in the DHT.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This data structure defines the header of an URL record stored in the DHT. It is followed by the URL itself (without a terminating zero).
+ * URL records are stored under the hash of the URL using the GNUNET_BLOCK_TYPE_SEARCH_URL block type.
+ */
+struct __attribute__((__packed__)) gnunet_search_dht_url_record {
+	/**
+	 * @brief This member stores the remaining crawling depth of the URL (see URL processor component).
+	 */
+	uint8_t depth;
+	/**
+	 * @brief This member stores the length of the URL following the header in network byte order.
+	 */
+	uint16_t url_length;
+};
+
 extern void gnunet_search_dht_url_list_put(char **urls, size_t size, unsigned int parameter);
+extern void gnunet_search_dht_keyword_put(char const *keyword, char const *url);
+extern void gnunet_search_dht_keyword_lookup(char const *keyword, uint64_t flow_id,
+		void (*miss_handler)(char const *keyword, uint64_t flow_id));
 extern void gnunet_search_dht_init();
 extern void gnunet_search_dht_free();
 
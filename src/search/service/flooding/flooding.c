@@ -32,122 +32,403 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
 #include <endian.h>
+#include <math.h>
 
 #include <gnunet/platform.h>
 #include <gnunet/gnunet_util_lib.h>
+#include <gnunet/gnunet_nse_service.h>
 
 #include "gnunet_protocols_search.h"
 #include "../client-communication/client-communication.h"
 #include "../storage/storage.h"
 #include "../globals/globals.h"
+#include "../routing-table/routing-table.h"
+#include "../result-cache/result-cache.h"
+#include "../summary/summary.h"
+#include "../compression/compression.h"
+#include "../normalization/normalization.h"
+#include "../../communication/pool.h"
 #include "flooding.h"
 
 #include <collections/arraylist/arraylist.h>
 #include <collections/queue/queue.h>
 
 /**
- * @brief This variable implements an output queue for messages.
+ * @brief This constant defines the default number of bytes that may be queued for a single neighbour.
+ */
+#define GNUNET_SEARCH_FLOODING_QUEUE_SIZE_DEFAULT (64*1024)
+
+/**
+ * @brief This enumeration defines the priority classes of outgoing messages.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This enumeration defines the priority classes of outgoing messages. Every neighbour has a separate output queue for each class; a
+ * message is only sent if all queues of higher priority are empty. Requests of local users come first, then responses and at last
+ * requests relayed on behalf of other peers. Under overload relayed requests are discarded first.
+ */
+enum gnunet_search_flooding_priority {
+	GNUNET_SEARCH_FLOODING_PRIORITY_LOCAL_REQUEST,
+	GNUNET_SEARCH_FLOODING_PRIORITY_RESPONSE,
+	GNUNET_SEARCH_FLOODING_PRIORITY_RELAYED_REQUEST,
+	GNUNET_SEARCH_FLOODING_PRIORITY_COUNT
+};
+
+/**
+ * @brief This constant array maps each priority class to the priority passed to the GNUnet core.
+ */
+static uint32_t const gnunet_search_flooding_priority_core_priorities[GNUNET_SEARCH_FLOODING_PRIORITY_COUNT] = { 3, 2, 1 };
+
+/**
+ * @brief This constant array maps each priority class to the maximal transmission delay in seconds passed to the GNUnet core.
+ */
+static unsigned int const gnunet_search_flooding_priority_max_delays[GNUNET_SEARCH_FLOODING_PRIORITY_COUNT] = { 60, 30, 10 };
+
+/**
+ * @brief This variable stores the maximal number of bytes that may be queued for a single neighbour.
+ */
+static unsigned long long gnunet_search_flooding_queue_size;
+/**
+ * @brief This variable stores the number of bytes queued for all neighbours.
+ */
+static unsigned long long gnunet_search_flooding_queued_bytes;
+/**
+ * @brief This variable stores the number of messages queued for all neighbours.
+ */
+static unsigned long long gnunet_search_flooding_queued_messages;
+
+/**
+ * @brief This constant defines the default fanout of the forwarding strategies.
+ */
+#define GNUNET_SEARCH_FLOODING_FANOUT_DEFAULT 3
+/**
+ * @brief This constant defines the default interval (in seconds) after which a requestor checks back on its random walkers.
+ */
+#define GNUNET_SEARCH_FLOODING_WALK_CHECK_INTERVAL_DEFAULT 2
+/**
+ * @brief This constant defines the default number of times a requestor restarts its random walkers.
+ */
+#define GNUNET_SEARCH_FLOODING_WALK_CHECK_ROUNDS_DEFAULT 3
+
+/**
+ * @brief This constant defines the default upper bound for the TTL of a message.
+ */
+#define GNUNET_SEARCH_FLOODING_TTL_LIMIT_DEFAULT 16
+/**
+ * @brief This constant defines the default TTL of the first ring of an expanding ring search.
+ */
+#define GNUNET_SEARCH_FLOODING_RING_TTL_INITIAL_DEFAULT 2
+/**
+ * @brief This constant defines the default time (in milliseconds) a request is expected to need for one hop.
+ */
+#define GNUNET_SEARCH_FLOODING_RING_HOP_TIMEOUT_DEFAULT 250
+/**
+ * @brief This constant defines the default number of responses needed to stop an expanding ring search.
+ */
+#define GNUNET_SEARCH_FLOODING_RING_RESULTS_MINIMUM_DEFAULT 1
+
+/**
+ * @brief This variable stores the upper bound for the TTL of a message; it is also used as TTL for responses.
+ */
+static uint8_t gnunet_search_flooding_ttl_limit;
+/**
+ * @brief This variable stores the maximal TTL of a request.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This variable stores the maximal TTL of a request. It is derived from the network size estimated by GNUnet's NSE service (see below); until the first
+ * estimate is available the configured upper bound is used.
+ */
+static uint8_t gnunet_search_flooding_ttl_maximum;
+/**
+ * @brief This variable stores the TTL of the first ring of an expanding ring search.
+ */
+static uint8_t gnunet_search_flooding_ring_ttl_initial;
+/**
+ * @brief This variable stores the time a request is expected to need for one hop; a ring is expanded in case not enough responses have been received within
+ * twice this time for each hop of the ring.
+ */
+static struct GNUNET_TIME_Relative gnunet_search_flooding_ring_hop_timeout;
+/**
+ * @brief This variable stores the number of responses needed to stop an expanding ring search.
+ */
+static unsigned long long gnunet_search_flooding_ring_results_minimum;
+/**
+ * @brief This variable stores a boolean value indicating whether a request answered from the result cache is still forwarded (with half of its TTL).
+ */
+static uint8_t gnunet_search_flooding_cache_hit_forward;
+/**
+ * @brief This constant defines the minimal payload size of a message for which compression is tried.
+ */
+#define GNUNET_SEARCH_FLOODING_COMPRESSION_THRESHOLD 128
+/**
+ * @brief This variable stores a boolean value indicating whether the payloads of requests and responses sent to neighbours are compressed.
+ */
+static uint8_t gnunet_search_flooding_compression;
+/**
+ * @brief This variable stores a boolean value indicating whether requests are only forwarded to neighbours whose keyword summaries match the request.
+ */
+static uint8_t gnunet_search_flooding_summary_routing;
+/**
+ * @brief This variable stores a reference to the GNUnet NSE handle used to retrieve network size estimates.
+ */
+static struct GNUNET_NSE_Handle *gnunet_search_flooding_nse_handle;
+
+/**
+ * @brief This variable stores the forwarding strategy used for requests that do not specify a strategy themselves.
+ */
+static uint8_t gnunet_search_flooding_strategy_default;
+/**
+ * @brief This variable stores the fanout used for requests that do not specify a fanout themselves.
+ */
+static uint8_t gnunet_search_flooding_fanout_default;
+/**
+ * @brief This variable stores the interval after which a requestor checks back on its random walkers.
+ */
+static struct GNUNET_TIME_Relative gnunet_search_flooding_walk_check_interval;
+/**
+ * @brief This variable stores the number of times a requestor restarts its random walkers.
+ */
+static unsigned long long gnunet_search_flooding_walk_check_rounds;
+
+/**
+ * @brief This data structure represents an immutable message buffer shared by all peers a message is sent to.
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This variable implements an output queue for messages. Since GNUnet does not allow the user to
- * queue more than one message at a time it is important to handle this situation correctly. New
- * mesage are enqueued in this queue and are sent subequently one after one.
+ * This data structure represents an immutable message buffer shared by all peers a message is sent to. The structure is followed by the
+ * GNUnet message header and the flooding message. Every message waiting in the output queue holds a reference to the buffer; the buffer
+ * is freed as soon as the last reference is released. Flooding a message to any number of peers thus only requires one buffer.
  */
-static queue_t *gnunet_search_flooding_message_queue;
+struct gnunet_search_flooding_buffer {
+	/**
+	 * @brief This member stores the number of references to the buffer.
+	 */
+	unsigned int references;
+	/**
+	 * @brief This member stores the size of the message including the GNUnet message header.
+	 */
+	size_t size;
+};
 
 /**
  * @brief This data structure is used to combine all parameters needed for a message waiting in the output queue.
  */
 struct gnunet_search_flooding_queued_message {
 	/**
-	 * @brief This member stores a reference to buffer to be sent.
+	 * @brief This member stores a reference to the shared buffer to be sent.
 	 */
-	void *buffer;
+	struct gnunet_search_flooding_buffer *buffer;
 	/**
-	 * @brief This member stores the size of the buffer.
+	 * @brief This member stores the peer to send the buffer to.
 	 */
-	size_t size;
-	struct GNUNET_PeerIdentity *peer;
+	struct GNUNET_PeerIdentity peer;
+	/**
+	 * @brief This member stores the priority class of the message.
+	 */
+	enum gnunet_search_flooding_priority priority;
 };
 
 /**
- * @brief This data structure stores all information needed to flood data to a given peer.
- *
- * \latexonly \\ \\ \endlatexonly
- * \em Detailed \em description \n
- * This data structure stores all information needed to flood data to a given peer. It is necessary since GNUnet uses an
- * iteration handler to iterate over all connected peers. This handler allows to pass a reference to a closure object; in order
- * to be able to pass more than one parameter to that handler these parameters have to be combined in a structure.
+ * @brief This variable stores the task scheduled to initiate the transmission of the next message.
+ */
+static GNUNET_SCHEDULER_TaskIdentifier gnunet_search_flooding_transmit_task;
+/**
+ * @brief This variable stores the time the task scheduled to initiate the transmission of the next message runs at.
+ */
+static struct GNUNET_TIME_Absolute gnunet_search_flooding_transmit_time;
+
+/**
+ * @brief This constant defines the default time (in milliseconds) requests are held back in order to bundle them with further requests.
+ */
+#define GNUNET_SEARCH_FLOODING_BUNDLE_WINDOW_DEFAULT 10
+/**
+ * @brief This variable stores the time requests are held back in order to bundle them with further requests.
+ */
+static struct GNUNET_TIME_Relative gnunet_search_flooding_bundle_window;
+
+/**
+ * @brief This variable stores a reference to the GNUnet core handle needed to communicate with other peers.
+ */
+static struct GNUNET_CORE_Handle *gnunet_search_flooding_core_handle;
+
+/**
+ * @brief This data structure represents a token bucket used to limit the rate of incoming requests.
  */
-struct gnunet_search_flooding_data_flood_parameters {
+struct gnunet_search_flooding_token_bucket {
 	/**
-	 * @brief This member stores a reference to sender peer that initiated the flooding.
-	 *
-	 * \latexonly \\ \\ \endlatexonly
-	 * \em Detailed \em description \n
-	 * This member stores a reference to sender peer that initiated the flooding. A value of NULL indicates that this flooding
-	 * has been been initiated locally. The sender is needed in order to prevent flooding the message back to its orginator; this
-	 * reduces the bandwidth needed.
+	 * @brief This member stores the number of tokens currently available.
+	 */
+	double tokens;
+	/**
+	 * @brief This member stores the time the bucket has been refilled last.
+	 */
+	struct GNUNET_TIME_Absolute refilled;
+};
+
+/**
+ * @brief This constant defines the default number of requests per second accepted from a single neighbour.
+ */
+#define GNUNET_SEARCH_FLOODING_REQUEST_RATE_NEIGHBOUR_DEFAULT 20
+/**
+ * @brief This constant defines the default number of requests a single neighbour may send in a burst.
+ */
+#define GNUNET_SEARCH_FLOODING_REQUEST_BURST_NEIGHBOUR_DEFAULT 40
+/**
+ * @brief This constant defines the default number of requests per second accepted from all neighbours.
+ */
+#define GNUNET_SEARCH_FLOODING_REQUEST_RATE_GLOBAL_DEFAULT 100
+/**
+ * @brief This constant defines the default number of requests all neighbours may send in a burst.
+ */
+#define GNUNET_SEARCH_FLOODING_REQUEST_BURST_GLOBAL_DEFAULT 200
+
+/**
+ * @brief This variable stores the number of requests per second accepted from a single neighbour.
+ */
+static unsigned long long gnunet_search_flooding_request_rate_neighbour;
+/**
+ * @brief This variable stores the number of requests a single neighbour may send in a burst.
+ */
+static unsigned long long gnunet_search_flooding_request_burst_neighbour;
+/**
+ * @brief This variable stores the number of requests per second accepted from all neighbours.
+ */
+static unsigned long long gnunet_search_flooding_request_rate_global;
+/**
+ * @brief This variable stores the number of requests all neighbours may send in a burst.
+ */
+static unsigned long long gnunet_search_flooding_request_burst_global;
+/**
+ * @brief This variable stores the token bucket limiting the rate of requests accepted from all neighbours.
+ */
+static struct gnunet_search_flooding_token_bucket gnunet_search_flooding_request_bucket;
+
+/**
+ * @brief This constant defines the number of buckets the requests are divided into by the hash of their keyword for ranking the neighbours.
+ */
+#define GNUNET_SEARCH_FLOODING_RANK_BUCKETS 16
+/**
+ * @brief This constant defines the number of requests a neighbour has to receive within a bucket before its rank is trusted.
+ */
+#define GNUNET_SEARCH_FLOODING_RANK_WARMUP 3
+/**
+ * @brief This constant defines the weight of a new observation in the moving averages of a rank.
+ */
+#define GNUNET_SEARCH_FLOODING_RANK_WEIGHT 0.2
+/**
+ * @brief This constant defines the default percentage of neighbours chosen at random instead of by rank.
+ */
+#define GNUNET_SEARCH_FLOODING_RANK_EXPLORATION_DEFAULT 10
+
+/**
+ * @brief This variable stores the percentage of neighbours chosen at random instead of by rank.
+ */
+static unsigned long long gnunet_search_flooding_rank_exploration;
+/**
+ * @brief This constant defines the maximal number of neighbours chosen for a single request; it is the maximal fanout a client may request.
+ */
+#define GNUNET_SEARCH_FLOODING_SELECTION_MAXIMUM UINT8_MAX
+/**
+ * @brief This variable stores the number of the current neighbour selection; neighbours chosen in the current selection are marked with it.
+ */
+static unsigned int gnunet_search_flooding_selection;
+
+/**
+ * @brief This data structure stores the history of the responses a neighbour delivered for the requests of one bucket.
+ */
+struct gnunet_search_flooding_rank {
+	/**
+	 * @brief This member stores the number of requests of the bucket forwarded to the neighbour.
 	 */
-	struct GNUNET_PeerIdentity *sender;
+	unsigned int requests;
 	/**
-	 * @brief This member stores a reference to the data to flood.
+	 * @brief This member stores the moving average of the number of results per request.
 	 */
-	void *data;
+	double yield;
 	/**
-	 * @brief This member stores the size of the data.
+	 * @brief This member stores the moving average of the time (in milliseconds) until the first result of a request has been received.
 	 */
-	size_t size;
+	double latency;
 };
 
 /**
- * @brief This data structure represents an entry in the routing table.
- *
- * \latexonly \\ \\ \endlatexonly
- * \em Detailed \em description \n
- * This data structure represents an entry in the routing table. The routing table is used to be able to forward response messages back
- * to their originator. Whenever a request passes a node it remembers the sending node and the flow id. Since the response will carry
- * the same flow id the node is able to look up the next hop using the flow id of the response message.
+ * @brief This data structure represents an entry in the neighbour table.
  */
-struct gnunet_search_flooding_routing_entry {
+struct gnunet_search_flooding_neighbour {
 	/**
-	 * @brief This member stores the flow (one request, possibly multiple responses) id associated with the message flow the routing entry is used for.
+	 * @brief This member stores the identity of the neighbour.
 	 */
-	uint64_t flow_id;
+	struct GNUNET_PeerIdentity identity;
+	/**
+	 * @brief This member stores the number of the last neighbour selection the neighbour has been chosen in (see above).
+	 */
+	unsigned int selected;
+	/**
+	 * @brief This member stores the token bucket limiting the rate of requests accepted from the neighbour.
+	 */
+	struct gnunet_search_flooding_token_bucket request_bucket;
+	/**
+	 * @brief This member stores the history of the responses delivered by the neighbour, one entry for each bucket of requests.
+	 */
+	struct gnunet_search_flooding_rank ranks[GNUNET_SEARCH_FLOODING_RANK_BUCKETS];
+	/**
+	 * @brief This member stores the output queues of the neighbour, one for each priority class.
+	 *
+	 * \latexonly \\ \\ \endlatexonly
+	 * \em Detailed \em description \n
+	 * This member stores the output queues of the neighbour, one for each priority class. Since GNUnet does not allow the user to
+	 * queue more than one message per peer at a time new messages are enqueued here and are sent subsequently one after one. A slow
+	 * neighbour thus only delays the messages destined for itself.
+	 */
+	queue_t *queues[GNUNET_SEARCH_FLOODING_PRIORITY_COUNT];
+	/**
+	 * @brief This member stores the number of bytes currently queued for the neighbour.
+	 */
+	size_t queued_bytes;
+	/**
+	 * @brief This member stores a reference to the message currently waiting for GNUnet to call the transmit_ready() function; it is
+	 * NULL in case no message is being transmitted to the neighbour.
+	 */
+	struct gnunet_search_flooding_queued_message *transmitting;
+	/**
+	 * @brief This member stores the GNUnet transmit handle of the message currently being transmitted to the neighbour.
+	 */
+	struct GNUNET_CORE_TransmitHandle *transmit_handle;
 	/**
-	 * @brief This member stores the next hop to forward response messages to.
+	 * @brief This member stores the time until which the requests queued for the neighbour are held back in order to bundle them.
 	 */
-	struct GNUNET_PeerIdentity next_hop;
+	struct GNUNET_TIME_Absolute hold_until;
 	/**
-	 * @brief This member stores a boolean value indicating whether the request originated locally. In that the data stored in the next_hop attribute is invalid.
+	 * @brief This member stores a reference to a request that did not fit into the last bundle; it is sent next. It is NULL in case there is no such request.
 	 */
-	uint8_t own_request;
+	struct gnunet_search_flooding_queued_message *deferred;
 };
 
 /**
- * @brief This variable stores a reference to the routing table.
+ * @brief This variable stores a reference to the neighbour table.
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This variable stores a reference to the routing table. It is implemented as a simple ring buffer using a FIFO replacement strategy. In case a response arrives for
- * some flow id that cannot be found in the routing table (since the entry has been replaced or the message is corrupt) the message is discarded.
+ * This variable stores a reference to the neighbour table. The table contains all peers currently connected to the local peer; it is
+ * maintained using the connect and disconnect notifications of the GNUnet core. The entries are stored contiguously; a disconnected
+ * peer is replaced by the last entry of the table.
  */
-static struct gnunet_search_flooding_routing_entry *gnunet_search_flooding_routing_table;
+static struct gnunet_search_flooding_neighbour *gnunet_search_flooding_neighbours;
 /**
- * @brief This variable stores the current length of routing table; it has fixed maximal length and will never shrink.
+ * @brief This variable stores the number of entries of the neighbour table.
  */
-static size_t gnunet_search_flooding_routing_table_length;
+static unsigned int gnunet_search_flooding_neighbours_length;
 /**
- * @brief This variable stores the next index of the routing table to be overwritten in case of a newly received request.
+ * @brief This variable stores the identity of the local peer; it is only valid once the connection to the GNUnet core has been established.
  */
-static size_t gnunet_search_flooding_routing_table_index;
-
+static struct GNUNET_PeerIdentity gnunet_search_flooding_identity;
 /**
- * @brief This variable stores a reference to the GNUnet core handle needed to communicate with other peers.
+ * @brief This variable stores a boolean value indicating whether the identity of the local peer is known.
  */
-static struct GNUNET_CORE_Handle *gnunet_search_flooding_core_handle;
+static char gnunet_search_flooding_identity_known;
 
 /**
  * @brief This variable stores a reference to a function that handles a newly received flooded message.
@@ -163,219 +444,1229 @@ static void (*_gnunet_search_flooding_message_notification_handler)(struct GNUNE
 		struct gnunet_search_flooding_message *, size_t);
 
 /**
- * @brief This function frees a previously queued message and its buffer.
+ * @brief This function creates a new shared message buffer.
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This function frees a previously queued message, its buffer and peer. GNUnet does not call transmit_ready() in case an error occurs.
- * In that case the transmit_ready() function cannot take care of freeing the message data structure and its attributes. In order to solve that problem
- * this handler is scheduled to be called after the transmit_ready() function call. As this is a ordinary scheduled task it is called
- * despite possible communication errors. For this reason the approch prevents memory leaks.
+ * This function creates a new shared message buffer. It prepends the GNUnet message header to the data given. The caller holds the
+ * only reference to the buffer and may modify the header of the flooding message until the buffer is handed over to the output queue. The
+ * payload of requests and responses is compressed (see the compression component) in case that is enabled and saves space; the receiver
+ * decodes the payload before processing the message. The caller has to take care of not trying to send a message exceeding the allowed message size.
+ *
+ * @param data the data (the flooding message) to store in the buffer
+ * @param size the size of the data
  *
- * @param cls the GNUnet closure containing a reference to message to be freed
- * @tc the GNUnet task context (not used)
+ * @return a reference to the new buffer
  */
-static void gnunet_search_flooding_queued_message_free_task(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc) {
-	struct gnunet_search_flooding_queued_message *msg = (struct gnunet_search_flooding_queued_message*) cls;
-	GNUNET_free(msg->buffer);
-	GNUNET_free(msg->peer);
-	GNUNET_free(msg);
+static struct gnunet_search_flooding_buffer *gnunet_search_flooding_buffer_create(void const *data, size_t size) {
+	struct gnunet_search_flooding_message const *flooding_message = (struct gnunet_search_flooding_message const*) data;
+	void const *payload = flooding_message + 1;
+	size_t payload_size = size - sizeof(struct gnunet_search_flooding_message);
+
+	void *encoded = NULL;
+	size_t encoded_size = 0;
+	if(gnunet_search_flooding_compression && payload_size >= GNUNET_SEARCH_FLOODING_COMPRESSION_THRESHOLD
+			&& (flooding_message->type == GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_REQUEST
+					|| flooding_message->type == GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_RESPONSE)
+			&& !(flooding_message->flags & GNUNET_SEARCH_FLOODING_MESSAGE_FLAG_COMPRESSED))
+		encoded_size = gnunet_search_compression_encode(payload, payload_size, &encoded);
+	if(encoded_size) {
+		GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# flooding bytes saved by compression"),
+				payload_size - encoded_size, GNUNET_NO);
+		payload = encoded;
+		payload_size = encoded_size;
+	}
+
+	size_t message_size = sizeof(struct GNUNET_MessageHeader) + sizeof(struct gnunet_search_flooding_message) + payload_size;
+	struct gnunet_search_flooding_buffer *buffer = (struct gnunet_search_flooding_buffer*) gnunet_search_pool_allocate(
+			sizeof(struct gnunet_search_flooding_buffer) + message_size);
+	buffer->references = 1;
+	buffer->size = message_size;
+
+	struct GNUNET_MessageHeader *header = (struct GNUNET_MessageHeader*) (buffer + 1);
+	header->size = htons(message_size);
+	header->type = htons(GNUNET_MESSAGE_TYPE_SEARCH_FLOODING);
+	struct gnunet_search_flooding_message *buffer_flooding_message = (struct gnunet_search_flooding_message*) (header + 1);
+	memcpy(buffer_flooding_message, flooding_message, sizeof(struct gnunet_search_flooding_message));
+	memcpy(buffer_flooding_message + 1, payload, payload_size);
+	if(encoded_size)
+		buffer_flooding_message->flags |= GNUNET_SEARCH_FLOODING_MESSAGE_FLAG_COMPRESSED;
+
+	GNUNET_free_non_null(encoded);
+	return buffer;
+}
+
+/**
+ * @brief This function returns a reference to the flooding message stored in a shared message buffer.
+ *
+ * @param buffer the buffer
+ *
+ * @return a reference to the flooding message
+ */
+static struct gnunet_search_flooding_message *gnunet_search_flooding_buffer_flooding_message_get(
+		struct gnunet_search_flooding_buffer *buffer) {
+	return (struct gnunet_search_flooding_message*) ((struct GNUNET_MessageHeader*) (buffer + 1) + 1);
+}
+
+/**
+ * @brief This function releases a reference to a shared message buffer; the buffer is freed once the last reference is released.
+ *
+ * @param buffer the buffer
+ */
+static void gnunet_search_flooding_buffer_release(struct gnunet_search_flooding_buffer *buffer) {
+	GNUNET_assert(buffer->references > 0);
+	if(!--buffer->references)
+		gnunet_search_pool_release(buffer);
+}
+
+/**
+ * @brief This function frees a previously queued message and releases its reference to the shared buffer.
+ *
+ * @param msg the message to free
+ */
+static void gnunet_search_flooding_queued_message_free(struct gnunet_search_flooding_queued_message *msg) {
+	gnunet_search_flooding_buffer_release(msg->buffer);
+	gnunet_search_pool_release(msg);
+}
+
+/**
+ * @brief This function looks up a peer in the neighbour table.
+ *
+ * @param peer the peer to look up
+ *
+ * @return the index of the peer in the neighbour table or the length of the table in case the peer is not found
+ */
+static unsigned int gnunet_search_flooding_neighbour_index_get(struct GNUNET_PeerIdentity const *peer) {
+	unsigned int i;
+	for(i = 0; i < gnunet_search_flooding_neighbours_length; ++i)
+		if(!GNUNET_CRYPTO_hash_cmp(&gnunet_search_flooding_neighbours[i].identity.hashPubKey, &peer->hashPubKey))
+			break;
+	return i;
+}
+
+/**
+ * @brief This function publishes the current depth of the output queues using the statistics service.
+ */
+static void gnunet_search_flooding_queue_statistics_update() {
+	GNUNET_STATISTICS_set(gnunet_search_globals_statistics, gettext_noop("# flooding bytes queued"),
+			gnunet_search_flooding_queued_bytes, GNUNET_NO);
+	GNUNET_STATISTICS_set(gnunet_search_globals_statistics, gettext_noop("# flooding messages queued"),
+			gnunet_search_flooding_queued_messages, GNUNET_NO);
+}
+
+/**
+ * @brief This function dequeues a message from one of the output queues of a neighbour.
+ *
+ * @param neighbour the neighbour
+ * @param priority the priority class of the queue to dequeue the message from
+ *
+ * @return the message dequeued or NULL in case the queue is empty
+ */
+static struct gnunet_search_flooding_queued_message *gnunet_search_flooding_neighbour_queue_dequeue(
+		struct gnunet_search_flooding_neighbour *neighbour, enum gnunet_search_flooding_priority priority) {
+	if(!queue_get_length(neighbour->queues[priority]))
+		return NULL;
+
+	struct gnunet_search_flooding_queued_message *msg = (struct gnunet_search_flooding_queued_message*) queue_dequeue(
+			neighbour->queues[priority]);
+	neighbour->queued_bytes -= msg->buffer->size;
+	gnunet_search_flooding_queued_bytes -= msg->buffer->size;
+	gnunet_search_flooding_queued_messages--;
+
+	return msg;
+}
+
+/**
+ * @brief This function dequeues the message of the highest priority waiting for a neighbour.
+ *
+ * @param neighbour the neighbour
+ *
+ * @return the message dequeued or NULL in case all queues of the neighbour are empty
+ */
+static struct gnunet_search_flooding_queued_message *gnunet_search_flooding_neighbour_next_dequeue(
+		struct gnunet_search_flooding_neighbour *neighbour) {
+	for(unsigned int priority = 0; priority < GNUNET_SEARCH_FLOODING_PRIORITY_COUNT; ++priority) {
+		struct gnunet_search_flooding_queued_message *msg = gnunet_search_flooding_neighbour_queue_dequeue(neighbour,
+				(enum gnunet_search_flooding_priority) priority);
+		if(msg)
+			return msg;
+	}
+	return NULL;
+}
+
+/**
+ * @brief This function frees all messages waiting for a neighbour including the message currently being transmitted.
+ *
+ * @param neighbour the neighbour
+ */
+static void gnunet_search_flooding_neighbour_queues_free(struct gnunet_search_flooding_neighbour *neighbour) {
+	if(neighbour->transmit_handle) {
+		GNUNET_CORE_notify_transmit_ready_cancel(neighbour->transmit_handle);
+		gnunet_search_flooding_queued_message_free(neighbour->transmitting);
+		neighbour->transmit_handle = NULL;
+		neighbour->transmitting = NULL;
+	}
+	if(neighbour->deferred) {
+		gnunet_search_flooding_queued_message_free(neighbour->deferred);
+		neighbour->deferred = NULL;
+	}
+
+	struct gnunet_search_flooding_queued_message *msg;
+	while((msg = gnunet_search_flooding_neighbour_next_dequeue(neighbour)))
+		gnunet_search_flooding_queued_message_free(msg);
+	for(unsigned int priority = 0; priority < GNUNET_SEARCH_FLOODING_PRIORITY_COUNT; ++priority)
+		queue_free(neighbour->queues[priority]);
+
+	gnunet_search_flooding_queue_statistics_update();
 }
 
 static void gnunet_search_flooding_transmit_next(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc);
 
+/**
+ * @brief This function schedules the transmission of the next messages at a given time unless it has already been scheduled for that time or earlier.
+ *
+ * @param time the time to schedule the transmission at
+ */
+static void gnunet_search_flooding_transmit_schedule_at(struct GNUNET_TIME_Absolute time) {
+	if(gnunet_search_flooding_transmit_task != GNUNET_SCHEDULER_NO_TASK) {
+		if(gnunet_search_flooding_transmit_time.abs_value <= time.abs_value)
+			return;
+		GNUNET_SCHEDULER_cancel(gnunet_search_flooding_transmit_task);
+	}
+	gnunet_search_flooding_transmit_time = time;
+	gnunet_search_flooding_transmit_task = GNUNET_SCHEDULER_add_delayed(GNUNET_TIME_absolute_get_remaining(time),
+			&gnunet_search_flooding_transmit_next, NULL);
+}
+
+/**
+ * @brief This function schedules the transmission of the next messages unless this has already been done.
+ */
+static void gnunet_search_flooding_transmit_schedule() {
+	gnunet_search_flooding_transmit_schedule_at(GNUNET_TIME_absolute_get());
+}
+
+/**
+ * @brief This function bundles requests waiting for a neighbour with the request dequeued first.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function bundles requests waiting for a neighbour with the request dequeued first. Requests are taken from the queues of the request
+ * classes in the order of their priority; relayed requests are only added in case no response is waiting. The bundle is limited to the maximal
+ * message size; a request that does not fit anymore is deferred and sent next. Every request is embedded into the bundle as a complete GNUnet
+ * message; the receiver processes the requests as if they had been received one by one. This way all requests keep their own flow and routing
+ * entries while the overhead per message is paid only once per bundle.
+ *
+ * @param neighbour the neighbour
+ * @param first the request dequeued first
+ *
+ * @return the message to transmit; this is the request dequeued first in case no other request is waiting
+ */
+static struct gnunet_search_flooding_queued_message *gnunet_search_flooding_bundle_build(
+		struct gnunet_search_flooding_neighbour *neighbour, struct gnunet_search_flooding_queued_message *first) {
+	size_t bundled_length = 1;
+	struct gnunet_search_flooding_queued_message **bundled = (struct gnunet_search_flooding_queued_message**) gnunet_search_pool_allocate(
+			sizeof(struct gnunet_search_flooding_queued_message*) * (queue_get_length(
+					neighbour->queues[GNUNET_SEARCH_FLOODING_PRIORITY_LOCAL_REQUEST])
+					+ queue_get_length(neighbour->queues[GNUNET_SEARCH_FLOODING_PRIORITY_RELAYED_REQUEST]) + 1));
+	bundled[0] = first;
+	size_t payload_size = first->buffer->size;
+
+	enum gnunet_search_flooding_priority priorities[] = { GNUNET_SEARCH_FLOODING_PRIORITY_LOCAL_REQUEST,
+			GNUNET_SEARCH_FLOODING_PRIORITY_RELAYED_REQUEST };
+	for(unsigned int i = 0; i < 2 && !neighbour->deferred; ++i) {
+		if(priorities[i] == GNUNET_SEARCH_FLOODING_PRIORITY_RELAYED_REQUEST
+				&& queue_get_length(neighbour->queues[GNUNET_SEARCH_FLOODING_PRIORITY_RESPONSE]))
+			break;
+		struct gnunet_search_flooding_queued_message *msg;
+		while((msg = gnunet_search_flooding_neighbour_queue_dequeue(neighbour, priorities[i]))) {
+			if(payload_size + msg->buffer->size > GNUNET_SEARCH_FLOODING_MESSAGE_MAXIMAL_PAYLOAD_SIZE) {
+				neighbour->deferred = msg;
+				break;
+			}
+			bundled[bundled_length++] = msg;
+			payload_size += msg->buffer->size;
+		}
+	}
+
+	if(bundled_length == 1) {
+		gnunet_search_pool_release(bundled);
+		return first;
+	}
+
+	size_t flooding_message_size = sizeof(struct gnunet_search_flooding_message) + payload_size;
+	struct gnunet_search_flooding_message *flooding_message = (struct gnunet_search_flooding_message*) gnunet_search_pool_allocate(
+			flooding_message_size);
+	flooding_message->flow_id = 0;
+	flooding_message->ttl = 1;
+	flooding_message->type = GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_BUNDLE;
+	flooding_message->strategy = GNUNET_SEARCH_FORWARDING_DEFAULT;
+	flooding_message->fanout = 0;
+	flooding_message->max_results = 0;
+	flooding_message->flags = 0;
+	char *payload = (char*) (flooding_message + 1);
+	for(size_t i = 0; i < bundled_length; ++i) {
+		memcpy(payload, bundled[i]->buffer + 1, bundled[i]->buffer->size);
+		payload += bundled[i]->buffer->size;
+	}
+
+	struct gnunet_search_flooding_queued_message *bundle = (struct gnunet_search_flooding_queued_message*) gnunet_search_pool_allocate(
+			sizeof(struct gnunet_search_flooding_queued_message));
+	bundle->buffer = gnunet_search_flooding_buffer_create(flooding_message, flooding_message_size);
+	memcpy(&bundle->peer, &neighbour->identity, sizeof(struct GNUNET_PeerIdentity));
+	bundle->priority = first->priority;
+	gnunet_search_pool_release(flooding_message);
+
+	GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# flooding bundles sent"), 1, GNUNET_NO);
+	GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# flooding requests bundled"),
+			bundled_length, GNUNET_NO);
+	for(size_t i = 0; i < bundled_length; ++i)
+		gnunet_search_flooding_queued_message_free(bundled[i]);
+	gnunet_search_pool_release(bundled);
+
+	return bundle;
+}
+
+/**
+ * @brief This function dequeues the next message to transmit to a neighbour.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function dequeues the next message to transmit to a neighbour. Responses waiting are sent first; then a request deferred from the last bundle
+ * is sent, otherwise the message of the highest priority is taken. Requests are held back until the bundling window of the neighbour has passed; a
+ * request is then bundled with the other requests waiting (see above).
+ *
+ * @param neighbour the neighbour
+ *
+ * @return the message to transmit or NULL in case no message is waiting or the requests are held back
+ */
+static struct gnunet_search_flooding_queued_message *gnunet_search_flooding_neighbour_transmit_dequeue(
+		struct gnunet_search_flooding_neighbour *neighbour) {
+	struct gnunet_search_flooding_queued_message *msg = gnunet_search_flooding_neighbour_queue_dequeue(neighbour,
+			GNUNET_SEARCH_FLOODING_PRIORITY_RESPONSE);
+	if(msg)
+		return msg;
+
+	if(GNUNET_TIME_absolute_get_remaining(neighbour->hold_until).rel_value
+			&& (neighbour->deferred
+					|| queue_get_length(neighbour->queues[GNUNET_SEARCH_FLOODING_PRIORITY_LOCAL_REQUEST])
+					|| queue_get_length(neighbour->queues[GNUNET_SEARCH_FLOODING_PRIORITY_RELAYED_REQUEST]))) {
+		gnunet_search_flooding_transmit_schedule_at(neighbour->hold_until);
+		return NULL;
+	}
+	msg = neighbour->deferred;
+	neighbour->deferred = NULL;
+	if(!msg)
+		msg = gnunet_search_flooding_neighbour_next_dequeue(neighbour);
+	if(msg && msg->priority != GNUNET_SEARCH_FLOODING_PRIORITY_RESPONSE)
+		msg = gnunet_search_flooding_bundle_build(neighbour, msg);
+	return msg;
+}
+
 /**
  * @brief This function is called by GNUnet is case a new buffer is available for a message to be sent.
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This function is called by GNUnet is case a new buffer is available for a message to be sent. This function also takes
- * care of initiating the transmission of the next message waiting in the output queue.
+ * This function is called by GNUnet is case a new buffer is available for a message to be sent. GNUnet also calls the function with a NULL
+ * buffer in case the message could not be transmitted in time; in both cases the queued message is freed afterwards. This function also takes
+ * care of initiating the transmission of the next message waiting for the neighbour.
  *
- * @param cls the GNUnet closure
+ * @param cls the GNUnet closure containing a reference to the queued message
  * @param size the amout of buffer space available
  * @param buffer the output buffer the message shall be written to
  *
  * @return the amout of buffer space written
  */
 static size_t gnunet_search_flooding_notify_transmit_ready(void *cls, size_t size, void *buffer) {
-	struct GNUNET_MessageHeader *header = (struct GNUNET_MessageHeader*) cls;
-	size_t message_size = ntohs(header->size);
+	struct gnunet_search_flooding_queued_message *msg = (struct gnunet_search_flooding_queued_message*) cls;
+	size_t message_size = msg->buffer->size;
 
-	GNUNET_assert(size >= message_size);
-	if(size < message_size)
-		return 0;
+	unsigned int index = gnunet_search_flooding_neighbour_index_get(&msg->peer);
+	if(index < gnunet_search_flooding_neighbours_length) {
+		gnunet_search_flooding_neighbours[index].transmitting = NULL;
+		gnunet_search_flooding_neighbours[index].transmit_handle = NULL;
+	}
+
+	size_t written = 0;
+	if(buffer && size >= message_size) {
+		memcpy(buffer, msg->buffer + 1, message_size);
+		written = message_size;
+	} else
+		GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# flooding messages timed out"), 1,
+				GNUNET_NO);
 
-	memcpy(buffer, cls, message_size);
-//	free(cls);
+	gnunet_search_flooding_queued_message_free(msg);
 
-	GNUNET_SCHEDULER_add_delayed(GNUNET_TIME_UNIT_ZERO, &gnunet_search_flooding_transmit_next, NULL);
+	gnunet_search_flooding_transmit_schedule();
 
-	return message_size;
+	return written;
 }
 
 /**
- * @brief This function initiates the transmission of the next message.
+ * @brief This function initiates the transmission of the next messages.
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This function initiates the transmission of the next message. In order to do that it dequeues the message from the
- * output queue and calls the appropriate GNUnet function for the transmission of the message. The function is implemented as a GNUnet task; this is done in order to decouple it from the
- * transmit_ready() function call (see above).
+ * This function initiates the transmission of the next messages. For every neighbour that currently does not wait for a transmission to
+ * complete it dequeues the next message (see above) and calls the appropriate GNUnet function for the transmission of the message;
+ * the GNUnet priority and the maximal delay are derived from the priority class of the message. The function is implemented as a GNUnet
+ * task; this is done in order to decouple it from the transmit_ready() function call (see above).
  *
  * @param cls the GNUnet closure (not used)
  * @param tc the GNUnet task context (not used)
  */
 static void gnunet_search_flooding_transmit_next(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc) {
-	if(!queue_get_length(gnunet_search_flooding_message_queue))
+	gnunet_search_flooding_transmit_task = GNUNET_SCHEDULER_NO_TASK;
+
+	for(unsigned int i = 0; i < gnunet_search_flooding_neighbours_length; ++i) {
+		struct gnunet_search_flooding_neighbour *neighbour = &gnunet_search_flooding_neighbours[i];
+		if(neighbour->transmitting)
+			continue;
+
+		struct gnunet_search_flooding_queued_message *msg;
+		while((msg = gnunet_search_flooding_neighbour_transmit_dequeue(neighbour))) {
+			struct GNUNET_TIME_Relative max_delay = GNUNET_TIME_relative_multiply(GNUNET_TIME_UNIT_SECONDS,
+					gnunet_search_flooding_priority_max_delays[msg->priority]);
+
+			neighbour->transmitting = msg;
+			neighbour->transmit_handle = GNUNET_CORE_notify_transmit_ready(gnunet_search_flooding_core_handle, 0,
+					gnunet_search_flooding_priority_core_priorities[msg->priority], max_delay, &msg->peer,
+					msg->buffer->size, &gnunet_search_flooding_notify_transmit_ready, msg);
+			if(neighbour->transmit_handle)
+				break;
+
+			neighbour->transmitting = NULL;
+			gnunet_search_flooding_queued_message_free(msg);
+		}
+	}
+
+	gnunet_search_flooding_queue_statistics_update();
+}
+
+/**
+ * @brief This function enqueues a shared message buffer into an output queue of a neighbour.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function enqueues a shared message buffer into an output queue of a neighbour. For this purpose it acquires a new reference to the
+ * buffer; the buffer itself is not copied. The number of bytes queued for a single neighbour is bounded; in case the bound would be exceeded
+ * the oldest relayed requests are discarded first. If the message still does not fit it is discarded itself. A request arriving while no other
+ * request is waiting for the neighbour is sent at once in case the link to the neighbour is idle; in case another message is being transmitted
+ * to the neighbour it opens the bundling window of the neighbour and the requests are held back until the window has passed (see above). A
+ * request thus only waits in case it could not have been sent anyway. After that the function initiates the transmission of the next messages.
+ *
+ * @param neighbour the neighbour to send the message to
+ * @param buffer the buffer to send
+ * @param priority the priority class of the message
+ */
+static void gnunet_search_flooding_neighbour_message_enqueue(struct gnunet_search_flooding_neighbour *neighbour,
+		struct gnunet_search_flooding_buffer *buffer, enum gnunet_search_flooding_priority priority) {
+	struct gnunet_search_flooding_queued_message *dropped;
+	while(neighbour->queued_bytes + buffer->size > gnunet_search_flooding_queue_size
+			&& (dropped = gnunet_search_flooding_neighbour_queue_dequeue(neighbour,
+					GNUNET_SEARCH_FLOODING_PRIORITY_RELAYED_REQUEST))) {
+		gnunet_search_flooding_queued_message_free(dropped);
+		GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# flooding relayed requests dropped"),
+				1, GNUNET_NO);
+	}
+	if(neighbour->queued_bytes + buffer->size > gnunet_search_flooding_queue_size) {
+		GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# flooding messages dropped"), 1,
+				GNUNET_NO);
 		return;
+	}
 
-	struct gnunet_search_flooding_queued_message *msg = (struct gnunet_search_flooding_queued_message*) queue_dequeue(
-			gnunet_search_flooding_message_queue);
+	struct gnunet_search_flooding_queued_message *msg = (struct gnunet_search_flooding_queued_message*) gnunet_search_pool_allocate(
+			sizeof(struct gnunet_search_flooding_queued_message));
+	buffer->references++;
+	msg->buffer = buffer;
+	memcpy(&msg->peer, &neighbour->identity, sizeof(struct GNUNET_PeerIdentity));
+	msg->priority = priority;
+
+	if(priority != GNUNET_SEARCH_FLOODING_PRIORITY_RESPONSE
+			&& !queue_get_length(neighbour->queues[GNUNET_SEARCH_FLOODING_PRIORITY_LOCAL_REQUEST])
+			&& !queue_get_length(neighbour->queues[GNUNET_SEARCH_FLOODING_PRIORITY_RELAYED_REQUEST])
+			&& !neighbour->deferred)
+		neighbour->hold_until =
+				neighbour->transmitting ?
+						GNUNET_TIME_relative_to_absolute(gnunet_search_flooding_bundle_window) :
+						GNUNET_TIME_UNIT_ZERO_ABS;
+
+	queue_enqueue(neighbour->queues[priority], msg);
+	neighbour->queued_bytes += buffer->size;
+	gnunet_search_flooding_queued_bytes += buffer->size;
+	gnunet_search_flooding_queued_messages++;
+
+	if(priority == GNUNET_SEARCH_FLOODING_PRIORITY_RESPONSE)
+		gnunet_search_flooding_transmit_schedule();
+	else
+		gnunet_search_flooding_transmit_schedule_at(neighbour->hold_until);
+}
+
+/**
+ * @brief This function sends a shared message buffer to a peer.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function sends a shared message buffer to a peer. The message is discarded in case the peer is no longer connected.
+ *
+ * @param peer the peer to send the message to
+ * @param buffer the buffer to send
+ * @param priority the priority class of the message
+ */
+static void gnunet_search_flooding_to_peer_message_send(const struct GNUNET_PeerIdentity *peer,
+		struct gnunet_search_flooding_buffer *buffer, enum gnunet_search_flooding_priority priority) {
+	unsigned int index = gnunet_search_flooding_neighbour_index_get(peer);
+	if(index == gnunet_search_flooding_neighbours_length)
+		return;
+	gnunet_search_flooding_neighbour_message_enqueue(&gnunet_search_flooding_neighbours[index], buffer, priority);
+}
+
+/**
+ * @brief This function returns the bucket a request belongs to for ranking the neighbours.
+ *
+ * @param routing_entry the routing entry of the flow of the request
+ *
+ * @return the bucket
+ */
+static unsigned int gnunet_search_flooding_rank_bucket_get(struct gnunet_search_routing_table_entry const *routing_entry) {
+	return routing_entry->query.bits[0] % GNUNET_SEARCH_FLOODING_RANK_BUCKETS;
+}
+
+/**
+ * @brief This function computes the score of a neighbour for a bucket of requests.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function computes the score of a neighbour for a bucket of requests. The score is the average number of results per request divided by
+ * the average latency of the first result (in seconds, plus one). As long as a neighbour has received only a few requests of the bucket its score
+ * is infinite; new neighbours are thus tried first.
+ *
+ * @param rank the history of the neighbour for the bucket
+ *
+ * @return the score
+ */
+static double gnunet_search_flooding_rank_score(struct gnunet_search_flooding_rank const *rank) {
+	if(rank->requests < GNUNET_SEARCH_FLOODING_RANK_WARMUP)
+		return HUGE_VAL;
+	return rank->yield / (1 + rank->latency / 1000);
+}
+
+/**
+ * @brief This function forwards a request to a neighbour and records the request in the history of the neighbour.
+ *
+ * @param neighbour the neighbour
+ * @param buffer the buffer to send
+ * @param priority the priority class of the message
+ * @param routing_entry the routing entry of the flow
+ */
+static void gnunet_search_flooding_neighbour_request_forward(struct gnunet_search_flooding_neighbour *neighbour,
+		struct gnunet_search_flooding_buffer *buffer, enum gnunet_search_flooding_priority priority,
+		struct gnunet_search_routing_table_entry *routing_entry) {
+	struct gnunet_search_flooding_rank *rank = &neighbour->ranks[gnunet_search_flooding_rank_bucket_get(routing_entry)];
+	rank->requests++;
+	rank->yield *= 1 - GNUNET_SEARCH_FLOODING_RANK_WEIGHT;
+
+	gnunet_search_flooding_neighbour_message_enqueue(neighbour, buffer, priority);
+}
+
+/**
+ * @brief This function records a response in the history of the neighbour it has been received from.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function records a response in the history of the neighbour it has been received from. Every new result raises the neighbour's yield for the
+ * bucket of the request; the yield decays with every request forwarded to the neighbour (see above). The latency is measured for the first
+ * response of every neighbour to a flow since that is what the user waits for; a bit set in the routing entry tracks the neighbours that have
+ * already responded.
+ *
+ * @param sender the neighbour the response has been received from
+ * @param routing_entry the routing entry of the flow
+ * @param results the new results of the response; every result is terminated by a zero byte.
+ * @param results_size the size of the results
+ */
+static void gnunet_search_flooding_rank_response_record(struct GNUNET_PeerIdentity const *sender,
+		struct gnunet_search_routing_table_entry *routing_entry, char const *results, size_t results_size) {
+	unsigned int index = gnunet_search_flooding_neighbour_index_get(sender);
+	if(index == gnunet_search_flooding_neighbours_length)
+		return;
+	struct gnunet_search_flooding_rank *rank =
+			&gnunet_search_flooding_neighbours[index].ranks[gnunet_search_flooding_rank_bucket_get(routing_entry)];
+
+	unsigned int results_count = 0;
+	for(size_t i = 0; i < results_size; ++i)
+		if(!results[i])
+			results_count++;
+	rank->yield += GNUNET_SEARCH_FLOODING_RANK_WEIGHT * results_count;
+
+	uint64_t responder = (uint64_t) 1 << (sender->hashPubKey.bits[0] % 64);
+	if(routing_entry->responders & responder)
+		return;
+	routing_entry->responders |= responder;
+	double latency = GNUNET_TIME_absolute_get_duration(routing_entry->forwarded).rel_value;
+	if(rank->latency == 0)
+		rank->latency = latency;
+	else
+		rank->latency = (1 - GNUNET_SEARCH_FLOODING_RANK_WEIGHT) * rank->latency + GNUNET_SEARCH_FLOODING_RANK_WEIGHT * latency;
+}
 
-	struct GNUNET_TIME_Relative max_delay = GNUNET_TIME_relative_get_minute_();
-	struct GNUNET_TIME_Relative gct = GNUNET_TIME_relative_add(max_delay, GNUNET_TIME_relative_get_second_());
+/**
+ * @brief This function tests whether a neighbour may be chosen in the current neighbour selection.
+ *
+ * @param neighbour the neighbour
+ * @param sender the peer the data has been received from; it may be NULL in case the request originated locally.
+ *
+ * @return a boolean value indicating whether the neighbour may be chosen (1) or not (0)
+ */
+static char gnunet_search_flooding_neighbour_selectable(struct gnunet_search_flooding_neighbour const *neighbour,
+		struct GNUNET_PeerIdentity const *sender) {
+	return neighbour->selected != gnunet_search_flooding_selection
+			&& (!sender || GNUNET_CRYPTO_hash_cmp(&sender->hashPubKey, &neighbour->identity.hashPubKey));
+}
+
+/**
+ * @brief This function chooses neighbours not chosen before in the current neighbour selection at random.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function chooses neighbours not chosen before in the current neighbour selection at random. The neighbours are sampled in a single pass
+ * over the neighbour table (reservoir sampling); the chosen neighbours are marked as selected.
+ *
+ * @param sender the peer the data has been received from; it may be NULL in case the request originated locally.
+ * @param count the number of neighbours to choose; it must not exceed the maximal selection size.
+ * @param chosen the array to store the indices of the chosen neighbours in
+ *
+ * @return the number of neighbours chosen
+ */
+static unsigned int gnunet_search_flooding_neighbours_random_choose(struct GNUNET_PeerIdentity const *sender,
+		unsigned int count, unsigned int *chosen) {
+	unsigned int chosen_length = 0;
+	unsigned int seen = 0;
+	for(unsigned int i = 0; i < gnunet_search_flooding_neighbours_length && count; ++i) {
+		if(!gnunet_search_flooding_neighbour_selectable(&gnunet_search_flooding_neighbours[i], sender))
+			continue;
+		seen++;
+		if(chosen_length < count)
+			chosen[chosen_length++] = i;
+		else {
+			unsigned int slot = GNUNET_CRYPTO_random_u32(GNUNET_CRYPTO_QUALITY_WEAK, seen);
+			if(slot < count)
+				chosen[slot] = i;
+		}
+	}
+	for(unsigned int i = 0; i < chosen_length; ++i)
+		gnunet_search_flooding_neighbours[chosen[i]].selected = gnunet_search_flooding_selection;
+	return chosen_length;
+}
 
-	GNUNET_CORE_notify_transmit_ready(gnunet_search_flooding_core_handle, 0, 0, max_delay, msg->peer, msg->size,
-			&gnunet_search_flooding_notify_transmit_ready, msg->buffer);
+/**
+ * @brief This function sends data to the neighbours ranked highest for the bucket of a request.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function sends data to the neighbours ranked highest for the bucket of a request (see above); the neighbours are chosen in the order of their
+ * rank. Every neighbour is chosen at most once and the data is not sent back to the peer it has been received from. A configurable percentage of the
+ * neighbours is chosen at random instead; together with the preference of neighbours whose rank is not yet trusted this makes sure that new
+ * neighbours and neighbours that improved still receive requests. The ranked neighbours are selected in a single pass over the neighbour table
+ * keeping the best neighbours in a fixed-size array sorted by score; no memory is allocated.
+ *
+ * @param sender the peer the data has been received from; it may be NULL in case the request originated locally.
+ * @param buffer the buffer to send
+ * @param priority the priority class of the message
+ * @param count the number of neighbours to send the data to
+ * @param routing_entry the routing entry of the flow
+ */
+static void gnunet_search_flooding_neighbours_ranked_send(struct GNUNET_PeerIdentity const *sender,
+		struct gnunet_search_flooding_buffer *buffer, enum gnunet_search_flooding_priority priority, unsigned int count,
+		struct gnunet_search_routing_table_entry *routing_entry) {
+	unsigned int chosen[GNUNET_SEARCH_FLOODING_SELECTION_MAXIMUM];
+	double chosen_scores[GNUNET_SEARCH_FLOODING_SELECTION_MAXIMUM];
+	count = GNUNET_MIN(count, GNUNET_SEARCH_FLOODING_SELECTION_MAXIMUM);
+	gnunet_search_flooding_selection++;
+
+	unsigned int explored = 0;
+	for(unsigned int i = 0; i < count; ++i)
+		if(GNUNET_CRYPTO_random_u32(GNUNET_CRYPTO_QUALITY_WEAK, 100) < gnunet_search_flooding_rank_exploration)
+			explored++;
+	unsigned int ranked = count - explored;
+
+	unsigned int bucket = gnunet_search_flooding_rank_bucket_get(routing_entry);
+	unsigned int chosen_length = 0;
+	for(unsigned int i = 0; i < gnunet_search_flooding_neighbours_length && ranked; ++i) {
+		if(!gnunet_search_flooding_neighbour_selectable(&gnunet_search_flooding_neighbours[i], sender))
+			continue;
+		double score = gnunet_search_flooding_rank_score(&gnunet_search_flooding_neighbours[i].ranks[bucket]);
+		if(chosen_length == ranked && score <= chosen_scores[chosen_length - 1])
+			continue;
+		unsigned int position = chosen_length < ranked ? chosen_length++ : chosen_length - 1;
+		while(position && chosen_scores[position - 1] < score) {
+			chosen[position] = chosen[position - 1];
+			chosen_scores[position] = chosen_scores[position - 1];
+			position--;
+		}
+		chosen[position] = i;
+		chosen_scores[position] = score;
+	}
+	for(unsigned int i = 0; i < chosen_length; ++i)
+		gnunet_search_flooding_neighbours[chosen[i]].selected = gnunet_search_flooding_selection;
 
 	/*
-	 * Todo: Save and free...
+	 * In case fewer neighbours than ranked slots exist all of them have been chosen already and the exploration finds none.
 	 */
-	GNUNET_SCHEDULER_add_delayed(gct, &gnunet_search_flooding_queued_message_free_task, msg);
+	explored = gnunet_search_flooding_neighbours_random_choose(sender, count - chosen_length, chosen + chosen_length);
+	if(explored)
+		GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# neighbours explored"), explored,
+				GNUNET_NO);
+	chosen_length += explored;
+
+	for(unsigned int i = 0; i < chosen_length; ++i)
+		gnunet_search_flooding_neighbour_request_forward(&gnunet_search_flooding_neighbours[chosen[i]], buffer, priority,
+				routing_entry);
 }
 
 /**
- * @brief This function sends data to a peer.
+ * @brief This function floods data to all known peers.
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This function sends data to a peer. For this purpose it prepends the GNUnet message header and enqueues the message into the
- * output queue. After that it adds a new task to send the message. The caller has to take care of not trying to send a message
- * exceeding the allowed message size.
+ * This function floods data to all known peers. The peers are taken from the neighbour table which is kept up to date using the connect
+ * and disconnect notifications of the GNUnet core; flooding thus does not require any communication with the core service. The data
+ * is not sent back to the peer it has been received from. Since every neighbour receives the data no ranking is applied. All peers share
+ * the same message buffer.
  *
- * @param peer the peer to send the message to
- * @param data the data to send
- * @param size the size of the data so send
+ * @param sender the peer that initiated the flooding; it may be NULL in case the request originated locally.
+ * @param buffer the buffer to flood
+ * @param priority the priority class of the message
+ * @param fanout the fanout of the strategy (not used)
+ * @param routing_entry the routing entry of the flow
  */
-static void gnunet_search_flooding_to_peer_message_send(const struct GNUNET_PeerIdentity *peer, void *data, size_t size) {
-	size_t message_size = sizeof(struct GNUNET_MessageHeader) + size;
-	void *buffer = GNUNET_malloc(message_size);
-	memcpy(buffer + sizeof(struct GNUNET_MessageHeader), data, size);
+static void gnunet_search_flooding_strategy_flood_forward(struct GNUNET_PeerIdentity const *sender,
+		struct gnunet_search_flooding_buffer *buffer, enum gnunet_search_flooding_priority priority, unsigned int fanout,
+		struct gnunet_search_routing_table_entry *routing_entry) {
+	for(unsigned int i = 0; i < gnunet_search_flooding_neighbours_length; ++i) {
+		struct gnunet_search_flooding_neighbour *neighbour = &gnunet_search_flooding_neighbours[i];
+		if(sender && !GNUNET_CRYPTO_hash_cmp(&sender->hashPubKey, &neighbour->identity.hashPubKey))
+			continue;
+		gnunet_search_flooding_neighbour_request_forward(neighbour, buffer, priority, routing_entry);
+	}
+}
 
-	struct GNUNET_MessageHeader *header = (struct GNUNET_MessageHeader*) buffer;
-	header->size = htons(message_size);
-	header->type = htons(GNUNET_MESSAGE_TYPE_SEARCH_FLOODING);
+/**
+ * @brief This function implements the gossip forwarding strategy; the data is sent to a number of neighbours chosen at random.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function implements the gossip forwarding strategy; the data is sent to a number of neighbours chosen at random. Unlike the random walk
+ * the choice does not depend on the rank of the neighbours; gossip thus spreads a request evenly over the overlay, independent of which
+ * neighbours answered requests of the same bucket before.
+ *
+ * @param sender the peer the data has been received from; it may be NULL in case the request originated locally.
+ * @param buffer the buffer to send
+ * @param priority the priority class of the message
+ * @param fanout the number of neighbours to send the data to
+ * @param routing_entry the routing entry of the flow
+ */
+static void gnunet_search_flooding_strategy_gossip_forward(struct GNUNET_PeerIdentity const *sender,
+		struct gnunet_search_flooding_buffer *buffer, enum gnunet_search_flooding_priority priority, unsigned int fanout,
+		struct gnunet_search_routing_table_entry *routing_entry) {
+	unsigned int chosen[GNUNET_SEARCH_FLOODING_SELECTION_MAXIMUM];
+	gnunet_search_flooding_selection++;
+	unsigned int chosen_length = gnunet_search_flooding_neighbours_random_choose(sender,
+			GNUNET_MIN(fanout, GNUNET_SEARCH_FLOODING_SELECTION_MAXIMUM), chosen);
+	for(unsigned int i = 0; i < chosen_length; ++i)
+		gnunet_search_flooding_neighbour_request_forward(&gnunet_search_flooding_neighbours[chosen[i]], buffer, priority,
+				routing_entry);
+}
 
-	struct GNUNET_PeerIdentity *_peer = (struct GNUNET_PeerIdentity*) GNUNET_malloc(sizeof(struct GNUNET_PeerIdentity));
-	memcpy(_peer, peer, sizeof(struct GNUNET_PeerIdentity));
+/**
+ * @brief This function implements the random walk forwarding strategy.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function implements the random walk forwarding strategy. The requestor starts one walker per unit of fanout by sending the data to
+ * that many neighbours; every other peer forwards a walker to exactly one neighbour. The next hops are chosen by their rank for the bucket of
+ * the request; the exploration of the ranking (see above) keeps the walks random. The requestor checks back periodically and starts new walkers
+ * in case no response has been received (see below).
+ *
+ * @param sender the peer the data has been received from; it is NULL in case the walkers are started locally.
+ * @param buffer the buffer to send
+ * @param priority the priority class of the message
+ * @param fanout the number of walkers
+ * @param routing_entry the routing entry of the flow
+ */
+static void gnunet_search_flooding_strategy_walk_forward(struct GNUNET_PeerIdentity const *sender,
+		struct gnunet_search_flooding_buffer *buffer, enum gnunet_search_flooding_priority priority, unsigned int fanout,
+		struct gnunet_search_routing_table_entry *routing_entry) {
+	gnunet_search_flooding_neighbours_ranked_send(sender, buffer, priority, sender ? 1 : fanout, routing_entry);
+}
 
-	struct gnunet_search_flooding_queued_message *msg = (struct gnunet_search_flooding_queued_message*) GNUNET_malloc(
-			sizeof(struct gnunet_search_flooding_queued_message));
-	msg->buffer = buffer;
-	msg->size = message_size;
-	msg->peer = _peer;
+/**
+ * @brief This function forwards a request to the neighbours whose keyword summaries match the request.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function forwards a request to the neighbours whose keyword summaries match the request (see the summary component). The summaries only
+ * cover a few hops; in case the request travels further than that the summaries cannot rule out any neighbour and the function leaves the
+ * forwarding to the strategy. Otherwise a neighbour whose summary does not contain the keyword on any level within the request's reach cannot
+ * lead to a peer knowing the keyword and the request is not sent to it at all.
+ *
+ * @param sender the peer the request has been received from; it may be NULL in case the request originated locally.
+ * @param buffer the buffer to send
+ * @param priority the priority class of the message
+ * @param routing_entry the routing entry of the flow
+ * @param keyword_hash the hash of the requested keyword
+ * @param hops the number of hops the request travels beyond the local peer
+ *
+ * @return a boolean value indicating whether the request has been handled (1) or has to be forwarded using the strategy (0)
+ */
+static uint8_t gnunet_search_flooding_summary_forward(struct GNUNET_PeerIdentity const *sender,
+		struct gnunet_search_flooding_buffer *buffer, enum gnunet_search_flooding_priority priority,
+		struct gnunet_search_routing_table_entry *routing_entry, GNUNET_HashCode const *keyword_hash, unsigned int hops) {
+	if(hops > GNUNET_SEARCH_SUMMARY_LEVELS)
+		return 0;
+
+	unsigned int forwarded = 0;
+	for(unsigned int i = 0; i < gnunet_search_flooding_neighbours_length; ++i) {
+		struct gnunet_search_flooding_neighbour *neighbour = &gnunet_search_flooding_neighbours[i];
+		if(sender && !GNUNET_CRYPTO_hash_cmp(&sender->hashPubKey, &neighbour->identity.hashPubKey))
+			continue;
+		if(!gnunet_search_summary_neighbour_may_contain(&neighbour->identity, keyword_hash, hops)) {
+			GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# requests pruned by summary"), 1,
+					GNUNET_NO);
+			continue;
+		}
+
+		gnunet_search_flooding_neighbour_request_forward(neighbour, buffer, priority, routing_entry);
+		forwarded++;
+	}
+	if(forwarded)
+		GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# requests routed by summary"), 1,
+				GNUNET_NO);
+	return 1;
+}
+
+/**
+ * @brief This function refills a token bucket according to the time passed since it has been refilled last.
+ *
+ * @param bucket the bucket to refill
+ * @param rate the number of tokens added per second
+ * @param burst the maximal number of tokens
+ * @param now the current time
+ */
+static void gnunet_search_flooding_token_bucket_refill(struct gnunet_search_flooding_token_bucket *bucket,
+		unsigned long long rate, unsigned long long burst, struct GNUNET_TIME_Absolute now) {
+	struct GNUNET_TIME_Relative elapsed = GNUNET_TIME_absolute_get_difference(bucket->refilled, now);
+	bucket->tokens += (double) elapsed.rel_value * rate / 1000;
+	if(bucket->tokens > burst)
+		bucket->tokens = burst;
+	bucket->refilled = now;
+}
+
+/**
+ * @brief This function decides whether a request received from a neighbour is accepted.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function decides whether a request received from a neighbour is accepted. Requests are limited by a token bucket per neighbour and a global
+ * token bucket; a request is only accepted in case both buckets contain a token. The sizes and refill rates of the buckets are configurable. This
+ * way a single neighbour cannot saturate the local peer's CPU and uplink by injecting requests that are processed and forwarded to all other
+ * neighbours.
+ *
+ * @param sender the neighbour the request has been received from
+ *
+ * @return a boolean value indicating whether the request is accepted (1) or not (0)
+ */
+static uint8_t gnunet_search_flooding_request_admit(struct GNUNET_PeerIdentity const *sender) {
+	struct GNUNET_TIME_Absolute now = GNUNET_TIME_absolute_get();
+
+	unsigned int index = gnunet_search_flooding_neighbour_index_get(sender);
+	if(index < gnunet_search_flooding_neighbours_length) {
+		struct gnunet_search_flooding_token_bucket *bucket = &gnunet_search_flooding_neighbours[index].request_bucket;
+		gnunet_search_flooding_token_bucket_refill(bucket, gnunet_search_flooding_request_rate_neighbour,
+				gnunet_search_flooding_request_burst_neighbour, now);
+		if(bucket->tokens < 1) {
+			GNUNET_STATISTICS_update(gnunet_search_globals_statistics,
+					gettext_noop("# requests rejected by neighbour rate limit"), 1, GNUNET_NO);
+			return 0;
+		}
+	}
+
+	gnunet_search_flooding_token_bucket_refill(&gnunet_search_flooding_request_bucket,
+			gnunet_search_flooding_request_rate_global, gnunet_search_flooding_request_burst_global, now);
+	if(gnunet_search_flooding_request_bucket.tokens < 1) {
+		GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# requests rejected by global rate limit"),
+				1, GNUNET_NO);
+		return 0;
+	}
+
+	gnunet_search_flooding_request_bucket.tokens--;
+	if(index < gnunet_search_flooding_neighbours_length)
+		gnunet_search_flooding_neighbours[index].request_bucket.tokens--;
+	GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# requests accepted"), 1, GNUNET_NO);
+	return 1;
+}
+
+/**
+ * @brief This data structure represents a forwarding strategy.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This data structure represents a forwarding strategy. The strategy is chosen by the requestor and carried in every request message;
+ * all peers thus forward a request using the same strategy.
+ */
+struct gnunet_search_flooding_strategy {
+	/**
+	 * @brief This member stores the name of the strategy as used in the configuration.
+	 */
+	char const *name;
+	/**
+	 * @brief This member stores a reference to the function forwarding a request to the neighbours.
+	 */
+	void (*forward)(struct GNUNET_PeerIdentity const *sender, struct gnunet_search_flooding_buffer *buffer,
+			enum gnunet_search_flooding_priority priority, unsigned int fanout,
+			struct gnunet_search_routing_table_entry *routing_entry);
+	/**
+	 * @brief This member stores a boolean value indicating whether a request that has already been seen is forwarded again instead
+	 * of being discarded; this is needed for random walkers crossing the path of another walker of the same flow.
+	 */
+	uint8_t duplicates_forward;
+};
+
+/**
+ * @brief This constant defines the number of entries of the strategy table.
+ */
+#define GNUNET_SEARCH_FLOODING_STRATEGIES_LENGTH 4
+
+/**
+ * @brief This constant array stores the strategy table; it is indexed by the GNUNET_SEARCH_FORWARDING_* constants.
+ */
+static struct gnunet_search_flooding_strategy const gnunet_search_flooding_strategies[GNUNET_SEARCH_FLOODING_STRATEGIES_LENGTH] = {
+		{ NULL, NULL, 0 }, { "flood", &gnunet_search_flooding_strategy_flood_forward, 0 }, { "gossip",
+				&gnunet_search_flooding_strategy_gossip_forward, 0 }, { "walk",
+				&gnunet_search_flooding_strategy_walk_forward, 1 } };
+
+/**
+ * @brief This data structure stores the state of the random walkers started by the local peer for one flow.
+ */
+struct gnunet_search_flooding_walk {
+	/**
+	 * @brief This member stores a reference to the previous element of the list of walks.
+	 */
+	struct gnunet_search_flooding_walk *prev;
+	/**
+	 * @brief This member stores a reference to the next element of the list of walks.
+	 */
+	struct gnunet_search_flooding_walk *next;
+	/**
+	 * @brief This member stores the flow id of the request.
+	 */
+	uint64_t flow_id;
+	/**
+	 * @brief This member stores a reference to the shared buffer containing the request; it is used to restart the walkers.
+	 */
+	struct gnunet_search_flooding_buffer *buffer;
+	/**
+	 * @brief This member stores the number of walkers.
+	 */
+	unsigned int fanout;
+	/**
+	 * @brief This member stores the number of times the walkers have been restarted.
+	 */
+	unsigned int rounds;
+	/**
+	 * @brief This member stores the check back task.
+	 */
+	GNUNET_SCHEDULER_TaskIdentifier task;
+};
+
+/**
+ * @brief This variable stores a reference to the head of the list of walks started by the local peer.
+ */
+static struct gnunet_search_flooding_walk *gnunet_search_flooding_walks_head;
+/**
+ * @brief This variable stores a reference to the tail of the list of walks started by the local peer.
+ */
+static struct gnunet_search_flooding_walk *gnunet_search_flooding_walks_tail;
+
+/**
+ * @brief This function frees a walk and removes it from the list of walks.
+ *
+ * @param walk the walk to free
+ */
+static void gnunet_search_flooding_walk_free(struct gnunet_search_flooding_walk *walk) {
+	if(walk->task != GNUNET_SCHEDULER_NO_TASK)
+		GNUNET_SCHEDULER_cancel(walk->task);
+	GNUNET_CONTAINER_DLL_remove(gnunet_search_flooding_walks_head, gnunet_search_flooding_walks_tail, walk);
+	gnunet_search_flooding_buffer_release(walk->buffer);
+	GNUNET_free(walk);
+}
+
+/**
+ * @brief This function checks back on the random walkers of a flow.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function checks back on the random walkers of a flow. In case a response has been received or the flow has expired the walk is
+ * finished. Otherwise the walkers have not found anything within their TTL and new walkers are started; this is repeated a configurable
+ * number of times. This way the requestor only pays for more messages in case the previous walkers have been unsuccessful.
+ *
+ * @param cls the GNUnet closure containing a reference to the walk
+ * @param tc the GNUnet task context (not used)
+ */
+static void gnunet_search_flooding_walk_check_back(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc) {
+	struct gnunet_search_flooding_walk *walk = (struct gnunet_search_flooding_walk*) cls;
+	walk->task = GNUNET_SCHEDULER_NO_TASK;
+
+	struct gnunet_search_routing_table_entry *routing_entry = gnunet_search_routing_table_get(walk->flow_id);
+	if(!routing_entry || routing_entry->responses || walk->rounds >= gnunet_search_flooding_walk_check_rounds) {
+		gnunet_search_flooding_walk_free(walk);
+		return;
+	}
+
+	walk->rounds++;
+	GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# random walkers restarted"), walk->fanout,
+			GNUNET_NO);
+	routing_entry->forwarded = GNUNET_TIME_absolute_get();
+	gnunet_search_flooding_strategy_walk_forward(NULL, walk->buffer, GNUNET_SEARCH_FLOODING_PRIORITY_LOCAL_REQUEST,
+			walk->fanout, routing_entry);
+
+	walk->task = GNUNET_SCHEDULER_add_delayed(gnunet_search_flooding_walk_check_interval,
+			&gnunet_search_flooding_walk_check_back, walk);
+}
+
+/**
+ * @brief This function starts checking back on the random walkers of a flow originating locally.
+ *
+ * @param flow_id the flow id of the request
+ * @param buffer the buffer containing the request; the function acquires its own reference to the buffer
+ * @param fanout the number of walkers
+ */
+static void gnunet_search_flooding_walk_start(uint64_t flow_id, struct gnunet_search_flooding_buffer *buffer,
+		unsigned int fanout) {
+	struct gnunet_search_flooding_walk *walk = (struct gnunet_search_flooding_walk*) GNUNET_malloc(
+			sizeof(struct gnunet_search_flooding_walk));
+	walk->flow_id = flow_id;
+	buffer->references++;
+	walk->buffer = buffer;
+	walk->fanout = fanout;
+	walk->rounds = 0;
+	walk->task = GNUNET_SCHEDULER_add_delayed(gnunet_search_flooding_walk_check_interval,
+			&gnunet_search_flooding_walk_check_back, walk);
+	GNUNET_CONTAINER_DLL_insert(gnunet_search_flooding_walks_head, gnunet_search_flooding_walks_tail, walk);
+}
+
+/**
+ * @brief This data structure stores the state of an expanding ring search started by the local peer.
+ */
+struct gnunet_search_flooding_ring {
+	/**
+	 * @brief This member stores a reference to the previous element of the list of rings.
+	 */
+	struct gnunet_search_flooding_ring *prev;
+	/**
+	 * @brief This member stores a reference to the next element of the list of rings.
+	 */
+	struct gnunet_search_flooding_ring *next;
+	/**
+	 * @brief This member stores the flow id of the request.
+	 */
+	uint64_t flow_id;
+	/**
+	 * @brief This member stores a reference to a private buffer containing the request; its TTL is the TTL of the current ring.
+	 */
+	struct gnunet_search_flooding_buffer *buffer;
+	/**
+	 * @brief This member stores the expansion task.
+	 */
+	GNUNET_SCHEDULER_TaskIdentifier task;
+};
+
+/**
+ * @brief This variable stores a reference to the head of the list of expanding ring searches started by the local peer.
+ */
+static struct gnunet_search_flooding_ring *gnunet_search_flooding_rings_head;
+/**
+ * @brief This variable stores a reference to the tail of the list of expanding ring searches started by the local peer.
+ */
+static struct gnunet_search_flooding_ring *gnunet_search_flooding_rings_tail;
 
-	queue_enqueue(gnunet_search_flooding_message_queue, msg);
+/**
+ * @brief This function frees a ring and removes it from the list of rings.
+ *
+ * @param ring the ring to free
+ */
+static void gnunet_search_flooding_ring_free(struct gnunet_search_flooding_ring *ring) {
+	if(ring->task != GNUNET_SCHEDULER_NO_TASK)
+		GNUNET_SCHEDULER_cancel(ring->task);
+	GNUNET_CONTAINER_DLL_remove(gnunet_search_flooding_rings_head, gnunet_search_flooding_rings_tail, ring);
+	gnunet_search_flooding_buffer_release(ring->buffer);
+	GNUNET_free(ring);
+}
 
-	GNUNET_SCHEDULER_add_delayed(GNUNET_TIME_UNIT_ZERO, &gnunet_search_flooding_transmit_next, NULL);
+/**
+ * @brief This function returns the time to wait for the responses to a ring of a given TTL.
+ *
+ * @param ttl the TTL of the ring
+ *
+ * @return the time to wait
+ */
+static struct GNUNET_TIME_Relative gnunet_search_flooding_ring_timeout_get(uint8_t ttl) {
+	return GNUNET_TIME_relative_multiply(gnunet_search_flooding_ring_hop_timeout, 2 * ttl);
 }
 
 /**
- * @brief This function is the GNUnet iteration handler called while iterating the connected peers.
+ * @brief This function expands the ring of an expanding ring search.
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This function is the GNUnet iteration handler called while iterating the connected peers. It is used to flood data to all known peers.
+ * This function expands the ring of an expanding ring search. In case enough responses have been received, the flow has expired or the
+ * maximal TTL has been reached the search is finished. Otherwise the request is issued again with twice the TTL using the same flow id; peers
+ * that have already seen the flow with a lower TTL forward the request again without answering it a second time.
  *
- * @param cls the GNUnet closure; it contains a reference to a data structure (see above) containing a parameters needed to send data to the current peer.
- * @param peer the peer of the current iteration
- * @param atsi a reference to the GNUnet ATS information (not used)
- * @param atsi_count the length of the ATS information (not used)
+ * @param cls the GNUnet closure containing a reference to the ring
+ * @param tc the GNUnet task context (not used)
  */
-static void gnunet_search_flooding_peer_iterate_handler(void *cls, const struct GNUNET_PeerIdentity *peer,
-		const struct GNUNET_ATS_Information *atsi, unsigned int atsi_count) {
-	if(!peer) {
-//		printf("Iterating done...\n");
-		struct gnunet_search_flooding_data_flood_parameters *parameters =
-				(struct gnunet_search_flooding_data_flood_parameters*) cls;
-		GNUNET_free(parameters->data);
-		if(parameters->sender)
-			GNUNET_free(parameters->sender);
-		GNUNET_free(parameters);
+static void gnunet_search_flooding_ring_expand(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc) {
+	struct gnunet_search_flooding_ring *ring = (struct gnunet_search_flooding_ring*) cls;
+	ring->task = GNUNET_SCHEDULER_NO_TASK;
+
+	struct gnunet_search_flooding_message *flooding_message = gnunet_search_flooding_buffer_flooding_message_get(
+			ring->buffer);
+	struct gnunet_search_routing_table_entry *routing_entry = gnunet_search_routing_table_get(ring->flow_id);
+	if(!routing_entry || routing_entry->responses >= gnunet_search_flooding_ring_results_minimum
+			|| flooding_message->ttl >= gnunet_search_flooding_ttl_maximum) {
+		gnunet_search_flooding_ring_free(ring);
 		return;
 	}
-	struct gnunet_search_flooding_data_flood_parameters *parameters =
-			(struct gnunet_search_flooding_data_flood_parameters*) cls;
 
-	if(parameters->sender && !GNUNET_CRYPTO_hash_cmp(&parameters->sender->hashPubKey, &peer->hashPubKey)) {
-//		printf("Skipping sender...\n");
-		return;
-	}
+	flooding_message->ttl = GNUNET_MIN(2 * flooding_message->ttl, gnunet_search_flooding_ttl_maximum);
+	GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# expanding ring re-issues"), 1,
+			GNUNET_NO);
 
-	struct GNUNET_CRYPTO_HashAsciiEncoded result;
-	GNUNET_CRYPTO_hash_to_enc(&peer->hashPubKey, &result);
-//	printf("Flooding message to peer %.*s...\n", 104, (char*) &result);
+	ring->task = GNUNET_SCHEDULER_add_delayed(gnunet_search_flooding_ring_timeout_get(flooding_message->ttl),
+			&gnunet_search_flooding_ring_expand, ring);
 
-	gnunet_search_flooding_to_peer_message_send(peer, parameters->data, parameters->size);
+	gnunet_search_flooding_peer_local_message_process((struct GNUNET_MessageHeader*) (ring->buffer + 1));
 }
 
 /**
- * @brief This function floods data to all known peers.
+ * @brief This function starts an expanding ring search for a request originating locally.
+ *
+ * @param flow_id the flow id of the request
+ * @param flooding_message the request as issued for the first ring
+ * @param flooding_message_size the size of the request
+ */
+static void gnunet_search_flooding_ring_start(uint64_t flow_id, struct gnunet_search_flooding_message const *flooding_message,
+		size_t flooding_message_size) {
+	if(flooding_message->ttl >= gnunet_search_flooding_ttl_maximum)
+		return;
+
+	struct gnunet_search_flooding_ring *ring = (struct gnunet_search_flooding_ring*) GNUNET_malloc(
+			sizeof(struct gnunet_search_flooding_ring));
+	ring->flow_id = flow_id;
+	ring->buffer = gnunet_search_flooding_buffer_create(flooding_message, flooding_message_size);
+	ring->task = GNUNET_SCHEDULER_add_delayed(gnunet_search_flooding_ring_timeout_get(flooding_message->ttl),
+			&gnunet_search_flooding_ring_expand, ring);
+	GNUNET_CONTAINER_DLL_insert(gnunet_search_flooding_rings_head, gnunet_search_flooding_rings_tail, ring);
+}
+
+/**
+ * @brief This function is called by GNUnet in case a new network size estimate is available; it derives the maximal TTL of a request.
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This function floods data to all known peers. In order to do that it wraps up all parameters necessary in a data structure and initiates iterating
- * all peers using the appropriate GNUnet function.
+ * This function is called by GNUnet in case a new network size estimate is available; it derives the maximal TTL of a request. Assuming a
+ * random overlay in which every peer has about as many neighbours as the local peer the diameter of the network is about log(N) / log(d); one
+ * standard deviation of the estimate and one additional hop are added as a safety margin. The result is bounded by the configured limit.
  *
- * @param sender the peer that initiated the flooding; it may be NULL in case the request originated locally.
- * @param data the data to flood
- * @param size the size of the data to flood
- */
-static void gnunet_search_flooding_data_flood(struct GNUNET_PeerIdentity const *sender, void *data, size_t size) {
-	struct gnunet_search_flooding_data_flood_parameters *parameters =
-			(struct gnunet_search_flooding_data_flood_parameters*) GNUNET_malloc(
-					sizeof(struct gnunet_search_flooding_data_flood_parameters));
-	struct GNUNET_PeerIdentity *_sender;
-	if(sender) {
-		_sender = (struct GNUNET_PeerIdentity*) malloc(sizeof(struct GNUNET_PeerIdentity));
-		memcpy(_sender, sender, sizeof(struct GNUNET_PeerIdentity));
-	} else
-		_sender = NULL;
-
-	parameters->sender = _sender;
-	parameters->data = data;
-	parameters->size = size;
-
-	GNUNET_CORE_iterate_peers(gnunet_search_globals_cfg, &gnunet_search_flooding_peer_iterate_handler, parameters);
+ * @param cls the GNUnet closure (not used)
+ * @param timestamp the time the estimate has been made (not used)
+ * @param logestimate the binary logarithm of the estimated network size
+ * @param std_dev the standard deviation of the estimate
+ */
+static void gnunet_search_flooding_nse_notify(void *cls, struct GNUNET_TIME_Absolute timestamp, double logestimate,
+		double std_dev) {
+	double degree = GNUNET_MAX(2, gnunet_search_flooding_neighbours_length);
+	double hops = ceil((logestimate + std_dev) / log2(degree)) + 1;
+
+	if(hops < gnunet_search_flooding_ring_ttl_initial)
+		hops = gnunet_search_flooding_ring_ttl_initial;
+	if(hops > gnunet_search_flooding_ttl_limit)
+		hops = gnunet_search_flooding_ttl_limit;
+	gnunet_search_flooding_ttl_maximum = (uint8_t) hops;
+
+	GNUNET_STATISTICS_set(gnunet_search_globals_statistics, gettext_noop("# flooding maximal TTL"),
+			gnunet_search_flooding_ttl_maximum, GNUNET_NO);
 }
 
 /**
- * @brief This function retrieves the index of the next hop from the routing table by a given flow id.
+ * @brief This function is called by GNUnet once the connection to the core has been established; it stores the identity of the local peer.
  *
- * @param index a reference to a memory location to store the index in; it may be NULL - in that case the index is not stored.
- * @param flow_id the flow id to search for
+ * @param cls the GNUnet closure (not used)
+ * @param server the GNUnet core handle (not used)
+ * @param my_identity the identity of the local peer
+ */
+static void gnunet_search_flooding_core_init_notify(void *cls, struct GNUNET_CORE_Handle *server,
+		const struct GNUNET_PeerIdentity *my_identity) {
+	memcpy(&gnunet_search_flooding_identity, my_identity, sizeof(struct GNUNET_PeerIdentity));
+	gnunet_search_flooding_identity_known = 1;
+}
+
+/**
+ * @brief This function is called by GNUnet in case a new peer connects; it adds the peer to the neighbour table.
  *
- * @return a boolean value indicating success (1) or failure (0)
+ * @param cls the GNUnet closure (not used)
+ * @param peer the peer that connected
+ * @param atsi a reference to the GNUnet ATS information (not used)
+ * @param atsi_count the length of the ATS information (not used)
  */
-static uint8_t gnunet_search_flooding_routing_table_id_get_next_hop_index(size_t *index, uint64_t flow_id) {
-	for(size_t i = 0; i < gnunet_search_flooding_routing_table_length; ++i) {
-		if(gnunet_search_flooding_routing_table[i].flow_id == flow_id) {
-			if(index)
-				*index = i;
-			return 1;
-		}
-	}
-	return 0;
+static void gnunet_search_flooding_core_connect_notify(void *cls, const struct GNUNET_PeerIdentity *peer,
+		const struct GNUNET_ATS_Information *atsi, unsigned int atsi_count) {
+	if(gnunet_search_flooding_identity_known
+			&& !GNUNET_CRYPTO_hash_cmp(&gnunet_search_flooding_identity.hashPubKey, &peer->hashPubKey))
+		return;
+	if(gnunet_search_flooding_neighbour_index_get(peer) < gnunet_search_flooding_neighbours_length)
+		return;
+
+	gnunet_search_flooding_neighbours = (struct gnunet_search_flooding_neighbour*) GNUNET_realloc(
+			gnunet_search_flooding_neighbours,
+			sizeof(struct gnunet_search_flooding_neighbour) * (gnunet_search_flooding_neighbours_length + 1));
+	struct gnunet_search_flooding_neighbour *neighbour =
+			&gnunet_search_flooding_neighbours[gnunet_search_flooding_neighbours_length++];
+	memset(neighbour, 0, sizeof(struct gnunet_search_flooding_neighbour));
+	memcpy(&neighbour->identity, peer, sizeof(struct GNUNET_PeerIdentity));
+	neighbour->request_bucket.tokens = gnunet_search_flooding_request_burst_neighbour;
+	neighbour->request_bucket.refilled = GNUNET_TIME_absolute_get();
+	for(unsigned int priority = 0; priority < GNUNET_SEARCH_FLOODING_PRIORITY_COUNT; ++priority)
+		neighbour->queues[priority] = queue_construct();
+
+	gnunet_search_summary_neighbour_connect(peer);
+
+	GNUNET_STATISTICS_set(gnunet_search_globals_statistics, gettext_noop("# neighbours"),
+			gnunet_search_flooding_neighbours_length, GNUNET_NO);
 }
 
 /**
- * @brief This function tests whether an entry for a given flow id is contained in the routing table.
+ * @brief This function is called by GNUnet in case a peer disconnects; it removes the peer from the neighbour table.
  *
- * @param flow_id the flow id to search for
+ * @param cls the GNUnet closure (not used)
+ * @param peer the peer that disconnected
  */
-static char gnunet_search_flooding_routing_table_id_contains(uint64_t flow_id) {
-	return gnunet_search_flooding_routing_table_id_get_next_hop_index(NULL, flow_id);
+static void gnunet_search_flooding_core_disconnect_notify(void *cls, const struct GNUNET_PeerIdentity *peer) {
+	unsigned int index = gnunet_search_flooding_neighbour_index_get(peer);
+	if(index == gnunet_search_flooding_neighbours_length)
+		return;
+
+	gnunet_search_flooding_neighbour_queues_free(&gnunet_search_flooding_neighbours[index]);
+	gnunet_search_summary_neighbour_disconnect(peer);
+
+	gnunet_search_flooding_neighbours_length--;
+	if(index != gnunet_search_flooding_neighbours_length)
+		memcpy(&gnunet_search_flooding_neighbours[index],
+				&gnunet_search_flooding_neighbours[gnunet_search_flooding_neighbours_length],
+				sizeof(struct gnunet_search_flooding_neighbour));
+
+	GNUNET_STATISTICS_set(gnunet_search_globals_statistics, gettext_noop("# neighbours"),
+			gnunet_search_flooding_neighbours_length, GNUNET_NO);
 }
 
 /**
@@ -402,11 +1693,12 @@ static int gnunet_search_flooding_core_inbound_notify(void *cls, const struct GN
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This function is the handler to be called for a new request or a response destined for this node. In case a request is received it tries to find URLs for
- * the requested keyword using the storage component. In the event the search is successful the function creates a response message and sends it back to
- * the originator of the request. In case a response is received its data is delivered to the client using the client communication component.
+ * This function is the handler to be called for a new request or a response destined for this node. In case a request is received from a neighbour it tries
+ * to find URLs for the requested keyword using the storage component. In the event the search is successful the function creates a response message and sends
+ * it back to the originator of the request; requests originating locally are answered from the storage by the client communication component before they
+ * are sent. In case a response is received its data is delivered to the client using the client communication component.
  *
- * @param sender the sender of the message (not used)
+ * @param sender the sender of the message; it is NULL in case the message originated locally.
  * @param flooding_message the flooding message received
  * @param flooding_message_size the size of the flooding message
  */
@@ -414,6 +1706,12 @@ static void gnunet_search_flooding_message_notification_handler(struct GNUNET_Pe
 		struct gnunet_search_flooding_message *flooding_message, size_t flooding_message_size) {
 	switch(flooding_message->type) {
 		case GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_REQUEST: {
+			/*
+			 * Requests originating locally have already been answered from the local storage (see the client communication component).
+			 */
+			if(!sender)
+				break;
+
 			char *key = (char*) (flooding_message + 1);
 
 			/*
@@ -448,11 +1746,7 @@ static void gnunet_search_flooding_message_notification_handler(struct GNUNET_Pe
 			void *data = flooding_message + 1;
 			size_t data_size = flooding_message_size - sizeof(struct gnunet_search_flooding_message);
 
-			uint16_t request_id = gnunet_search_client_communication_by_flow_id_request_id_get(
-					be64toh(flooding_message->flow_id));
-
-			gnunet_search_client_communication_send_result(data, data_size, GNUNET_SEARCH_RESPONSE_TYPE_RESULT,
-					request_id);
+			gnunet_search_client_communication_flow_result_send(data, data_size, be64toh(flooding_message->flow_id));
 			break;
 		}
 	}
@@ -477,18 +1771,75 @@ static void gnunet_search_flooding_handlers_set(
  * This function initialises the flooding component. It also connects to the GNUnet core.
  */
 void gnunet_search_flooding_init() {
-	gnunet_search_flooding_message_queue = queue_construct();
-	gnunet_search_flooding_routing_table = (struct gnunet_search_flooding_routing_entry *) GNUNET_malloc(
-			sizeof(struct gnunet_search_flooding_routing_entry) * GNUNET_SEARCH_FLOODING_ROUTING_TABLE_SIZE);
-	gnunet_search_flooding_routing_table_length = 0;
-	gnunet_search_flooding_routing_table_index = 0;
+	gnunet_search_flooding_queue_size = gnunet_search_globals_config_number_get("FLOODING_QUEUE_SIZE",
+			GNUNET_SEARCH_FLOODING_QUEUE_SIZE_DEFAULT);
+	gnunet_search_flooding_queued_bytes = 0;
+	gnunet_search_flooding_queued_messages = 0;
+	gnunet_search_flooding_transmit_task = GNUNET_SCHEDULER_NO_TASK;
+	gnunet_search_flooding_bundle_window = gnunet_search_globals_config_time_get("BUNDLE_WINDOW",
+			GNUNET_TIME_relative_multiply(GNUNET_TIME_UNIT_MILLISECONDS, GNUNET_SEARCH_FLOODING_BUNDLE_WINDOW_DEFAULT));
+
+	static char const *strategy_names[] = { "flood", "gossip", "walk", NULL };
+	gnunet_search_flooding_strategy_default = GNUNET_SEARCH_FORWARDING_FLOOD
+			+ gnunet_search_globals_config_choice_get("FORWARDING_STRATEGY", strategy_names, 0);
+	gnunet_search_flooding_fanout_default = GNUNET_MIN(UINT8_MAX,
+			gnunet_search_globals_config_number_get("FORWARDING_FANOUT", GNUNET_SEARCH_FLOODING_FANOUT_DEFAULT));
+	gnunet_search_flooding_walk_check_interval = gnunet_search_globals_config_time_get("WALK_CHECK_INTERVAL",
+			GNUNET_TIME_relative_multiply(GNUNET_TIME_UNIT_SECONDS, GNUNET_SEARCH_FLOODING_WALK_CHECK_INTERVAL_DEFAULT));
+	gnunet_search_flooding_walk_check_rounds = gnunet_search_globals_config_number_get("WALK_CHECK_ROUNDS",
+			GNUNET_SEARCH_FLOODING_WALK_CHECK_ROUNDS_DEFAULT);
+	gnunet_search_flooding_walks_head = NULL;
+	gnunet_search_flooding_walks_tail = NULL;
+
+	gnunet_search_flooding_ttl_limit = GNUNET_MIN(UINT8_MAX,
+			gnunet_search_globals_config_number_get("TTL_LIMIT", GNUNET_SEARCH_FLOODING_TTL_LIMIT_DEFAULT));
+	gnunet_search_flooding_ttl_maximum = gnunet_search_flooding_ttl_limit;
+	gnunet_search_flooding_ring_ttl_initial = GNUNET_MIN(gnunet_search_flooding_ttl_limit,
+			gnunet_search_globals_config_number_get("RING_TTL_INITIAL", GNUNET_SEARCH_FLOODING_RING_TTL_INITIAL_DEFAULT));
+	gnunet_search_flooding_ring_hop_timeout = gnunet_search_globals_config_time_get("RING_HOP_TIMEOUT",
+			GNUNET_TIME_relative_multiply(GNUNET_TIME_UNIT_MILLISECONDS,
+					GNUNET_SEARCH_FLOODING_RING_HOP_TIMEOUT_DEFAULT));
+	gnunet_search_flooding_ring_results_minimum = gnunet_search_globals_config_number_get("RING_RESULTS_MINIMUM",
+			GNUNET_SEARCH_FLOODING_RING_RESULTS_MINIMUM_DEFAULT);
+	gnunet_search_flooding_rings_head = NULL;
+	gnunet_search_flooding_rings_tail = NULL;
+	gnunet_search_flooding_request_rate_neighbour = gnunet_search_globals_config_number_get("REQUEST_RATE_NEIGHBOUR",
+			GNUNET_SEARCH_FLOODING_REQUEST_RATE_NEIGHBOUR_DEFAULT);
+	gnunet_search_flooding_request_burst_neighbour = GNUNET_MAX(1,
+			gnunet_search_globals_config_number_get("REQUEST_BURST_NEIGHBOUR",
+					GNUNET_SEARCH_FLOODING_REQUEST_BURST_NEIGHBOUR_DEFAULT));
+	gnunet_search_flooding_request_rate_global = gnunet_search_globals_config_number_get("REQUEST_RATE_GLOBAL",
+			GNUNET_SEARCH_FLOODING_REQUEST_RATE_GLOBAL_DEFAULT);
+	gnunet_search_flooding_request_burst_global = GNUNET_MAX(1,
+			gnunet_search_globals_config_number_get("REQUEST_BURST_GLOBAL",
+					GNUNET_SEARCH_FLOODING_REQUEST_BURST_GLOBAL_DEFAULT));
+	gnunet_search_flooding_request_bucket.tokens = gnunet_search_flooding_request_burst_global;
+	gnunet_search_flooding_request_bucket.refilled = GNUNET_TIME_absolute_get();
+	gnunet_search_flooding_cache_hit_forward = GNUNET_NO != GNUNET_CONFIGURATION_get_value_yesno(gnunet_search_globals_cfg,
+			GNUNET_SEARCH_GLOBALS_CONFIG_SECTION, "RESULT_CACHE_HIT_FORWARD");
+	gnunet_search_flooding_rank_exploration = GNUNET_MIN(100,
+			gnunet_search_globals_config_number_get("RANKING_EXPLORATION", GNUNET_SEARCH_FLOODING_RANK_EXPLORATION_DEFAULT));
+	gnunet_search_flooding_compression = GNUNET_NO != GNUNET_CONFIGURATION_get_value_yesno(gnunet_search_globals_cfg,
+			GNUNET_SEARCH_GLOBALS_CONFIG_SECTION, "FLOODING_COMPRESSION");
+	gnunet_search_flooding_summary_routing = GNUNET_NO != GNUNET_CONFIGURATION_get_value_yesno(gnunet_search_globals_cfg,
+			GNUNET_SEARCH_GLOBALS_CONFIG_SECTION, "SUMMARY_ROUTING");
+	gnunet_search_flooding_nse_handle = GNUNET_NSE_connect(gnunet_search_globals_cfg,
+			&gnunet_search_flooding_nse_notify, NULL);
+
+	gnunet_search_routing_table_init();
 	_gnunet_search_flooding_message_notification_handler = NULL;
 
 	static struct GNUNET_CORE_MessageHandler core_handlers[] = { { &gnunet_search_flooding_core_inbound_notify,
 			GNUNET_MESSAGE_TYPE_SEARCH_FLOODING, 0 }, { NULL, 0, 0 } };
 
-	gnunet_search_flooding_core_handle = GNUNET_CORE_connect(gnunet_search_globals_cfg, 42, NULL, NULL, NULL, NULL,
-			NULL/*&gnunet_search_flooding_core_inbound_notify*/, 0, NULL, 0, core_handlers);
+	gnunet_search_flooding_neighbours = NULL;
+	gnunet_search_flooding_neighbours_length = 0;
+	gnunet_search_flooding_identity_known = 0;
+
+	gnunet_search_flooding_core_handle = GNUNET_CORE_connect(gnunet_search_globals_cfg, 42, NULL,
+			&gnunet_search_flooding_core_init_notify, &gnunet_search_flooding_core_connect_notify,
+			&gnunet_search_flooding_core_disconnect_notify, NULL/*&gnunet_search_flooding_core_inbound_notify*/, 0, NULL,
+			0, core_handlers);
 
 	gnunet_search_flooding_handlers_set(&gnunet_search_flooding_message_notification_handler);
 }
@@ -498,19 +1849,249 @@ void gnunet_search_flooding_init() {
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This function releases all resources held by the flooding component. It also disconnects from the GNUnet core and flushes the output queue.
+ * This function releases all resources held by the flooding component. It also flushes the output queues of all neighbours and disconnects from the GNUnet core.
  */
 void gnunet_search_flooding_free() {
+	while(gnunet_search_flooding_walks_head)
+		gnunet_search_flooding_walk_free(gnunet_search_flooding_walks_head);
+	while(gnunet_search_flooding_rings_head)
+		gnunet_search_flooding_ring_free(gnunet_search_flooding_rings_head);
+	if(gnunet_search_flooding_nse_handle)
+		GNUNET_NSE_disconnect(gnunet_search_flooding_nse_handle);
+
+	if(gnunet_search_flooding_transmit_task != GNUNET_SCHEDULER_NO_TASK)
+		GNUNET_SCHEDULER_cancel(gnunet_search_flooding_transmit_task);
+	for(unsigned int i = 0; i < gnunet_search_flooding_neighbours_length; ++i)
+		gnunet_search_flooding_neighbour_queues_free(&gnunet_search_flooding_neighbours[i]);
+
 	GNUNET_CORE_disconnect(gnunet_search_flooding_core_handle);
 
-	GNUNET_free(gnunet_search_flooding_routing_table);
+	gnunet_search_routing_table_free();
+	GNUNET_free_non_null(gnunet_search_flooding_neighbours);
+}
+
+/**
+ * @brief This function removes all results from a response that have already been forwarded for the flow.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function removes all results from a response that have already been forwarded for the flow. The hashes of the results forwarded are
+ * recorded in the routing entry of the flow; results repeated within the response are detected using a hash set of the response and removed as
+ * well. The results passing the filter are not yet recorded as forwarded since the response may still be dropped (see below). The bandwidth
+ * needed for the responses of a flow thus scales with the number of distinct results instead of the number of responding peers.
+ *
+ * @param routing_entry the routing entry of the flow
+ * @param results the results of the response; every result is terminated by a zero byte and the caller has to make sure that the last result is terminated.
+ * @param results_size the size of the results
+ * @param output the buffer to write the remaining results to; it has to be at least of the size of the results
+ *
+ * @return the size of the remaining results; 0 in case all results have been forwarded before
+ */
+static size_t gnunet_search_flooding_results_filter(struct gnunet_search_routing_table_entry *routing_entry,
+		char const *results, size_t results_size, char *output) {
+	struct GNUNET_CONTAINER_MultiHashMap *response_results = GNUNET_CONTAINER_multihashmap_create(16);
+	size_t output_size = 0;
+	for(size_t offset = 0; offset < results_size;) {
+		char const *result = results + offset;
+		size_t result_size = strlen(result) + 1;
+		offset += result_size;
+
+		GNUNET_HashCode hash;
+		GNUNET_CRYPTO_hash(result, result_size, &hash);
+		if(gnunet_search_routing_table_entry_result_test(routing_entry, &hash)
+				|| GNUNET_CONTAINER_multihashmap_put(response_results, &hash, NULL,
+						GNUNET_CONTAINER_MULTIHASHMAPOPTION_UNIQUE_ONLY) != GNUNET_OK) {
+			GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# duplicate results suppressed"),
+					1, GNUNET_NO);
+			continue;
+		}
+		memcpy(output + output_size, result, result_size);
+		output_size += result_size;
+	}
+	GNUNET_CONTAINER_multihashmap_destroy(response_results);
+	return output_size;
+}
+
+/**
+ * @brief This function records the results of a response as forwarded for the flow.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function records the results of a response as forwarded for the flow. It is called once the response has actually been relayed towards
+ * the requestor or delivered to the local client; results of a response dropped on the way are thus not suppressed in later responses.
+ *
+ * @param routing_entry the routing entry of the flow
+ * @param results the results of the response; every result is terminated by a zero byte.
+ * @param results_size the size of the results
+ */
+static void gnunet_search_flooding_results_mark(struct gnunet_search_routing_table_entry *routing_entry,
+		char const *results, size_t results_size) {
+	for(size_t offset = 0; offset < results_size;) {
+		size_t result_size = strlen(results + offset) + 1;
+		GNUNET_HashCode hash;
+		GNUNET_CRYPTO_hash(results + offset, result_size, &hash);
+		gnunet_search_routing_table_entry_result_set(routing_entry, &hash);
+		offset += result_size;
+	}
+}
+
+/**
+ * @brief This function applies the result limit of a flow to the new results of a response.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function applies the result limit of a flow to the new results of a response. The results are counted as forwarded; in case the limit
+ * requested by the requestor is reached the remaining results are cut off.
+ *
+ * @param routing_entry the routing entry of the flow
+ * @param results the new results of the response; every result is terminated by a zero byte.
+ * @param results_size the size of the results
+ *
+ * @return the size of the results within the limit
+ */
+static size_t gnunet_search_flooding_results_limit(struct gnunet_search_routing_table_entry *routing_entry,
+		char const *results, size_t results_size) {
+	size_t offset = 0;
+	while(offset < results_size
+			&& (!routing_entry->max_results || routing_entry->results < routing_entry->max_results)) {
+		offset += strlen(results + offset) + 1;
+		routing_entry->results++;
+	}
+	return offset;
+}
+
+/**
+ * @brief This function processes a message with a compressed payload.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function processes a message with a compressed payload. It decodes the payload and processes the decoded message (see below); a message
+ * that cannot be decoded or decodes to more than the maximal payload size is discarded.
+ *
+ * @param sender the sender peer of the message; it is NULL in case the message originated locally
+ * @param flooding_message the flooding message
+ * @param flooding_message_size the size of the flooding message
+ */
+static void gnunet_search_flooding_compressed_message_process(struct GNUNET_PeerIdentity const *sender,
+		struct gnunet_search_flooding_message const *flooding_message, size_t flooding_message_size) {
+	void *payload;
+	size_t payload_size = gnunet_search_compression_decode(flooding_message + 1,
+			flooding_message_size - sizeof(struct gnunet_search_flooding_message), &payload,
+			GNUNET_SEARCH_FLOODING_MESSAGE_MAXIMAL_PAYLOAD_SIZE);
+	if(!payload_size) {
+		GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# malformed compressed messages"), 1,
+				GNUNET_NO);
+		return;
+	}
+
+	size_t message_size = sizeof(struct GNUNET_MessageHeader) + sizeof(struct gnunet_search_flooding_message) + payload_size;
+	struct GNUNET_MessageHeader *message = (struct GNUNET_MessageHeader*) gnunet_search_pool_allocate(message_size);
+	message->size = htons(message_size);
+	message->type = htons(GNUNET_MESSAGE_TYPE_SEARCH_FLOODING);
+	struct gnunet_search_flooding_message *decoded_message = (struct gnunet_search_flooding_message*) (message + 1);
+	memcpy(decoded_message, flooding_message, sizeof(struct gnunet_search_flooding_message));
+	decoded_message->flags &= ~GNUNET_SEARCH_FLOODING_MESSAGE_FLAG_COMPRESSED;
+	memcpy(decoded_message + 1, payload, payload_size);
+	GNUNET_free(payload);
+
+	gnunet_search_flooding_peer_message_process(sender, message);
+	gnunet_search_pool_release(message);
+}
+
+/**
+ * @brief This function processes the requests of a bundle received from a neighbour.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function processes the requests of a bundle received from a neighbour. Every request embedded into the bundle is processed as if it had
+ * been received separately. Since the data is received from the network the sizes of the embedded messages are checked; only requests may be
+ * embedded. Processing stops at the first malformed message.
+ *
+ * @param sender the neighbour the bundle has been received from
+ * @param payload the payload of the bundle
+ * @param payload_size the size of the payload
+ */
+static void gnunet_search_flooding_bundle_process(struct GNUNET_PeerIdentity const *sender, void const *payload,
+		size_t payload_size) {
+	char const *current = (char const*) payload;
+	while(payload_size >= sizeof(struct GNUNET_MessageHeader) + sizeof(struct gnunet_search_flooding_message)) {
+		struct GNUNET_MessageHeader header;
+		memcpy(&header, current, sizeof(struct GNUNET_MessageHeader));
+		size_t message_size = ntohs(header.size);
+		if(message_size < sizeof(struct GNUNET_MessageHeader) + sizeof(struct gnunet_search_flooding_message)
+				|| message_size > payload_size || ntohs(header.type) != GNUNET_MESSAGE_TYPE_SEARCH_FLOODING
+				|| ((struct gnunet_search_flooding_message const*) (current + sizeof(struct GNUNET_MessageHeader)))->type
+						!= GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_REQUEST) {
+			GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# malformed bundles"), 1, GNUNET_NO);
+			return;
+		}
+
+		struct GNUNET_MessageHeader *message = (struct GNUNET_MessageHeader*) gnunet_search_pool_allocate(message_size);
+		memcpy(message, current, message_size);
+		gnunet_search_flooding_peer_message_process(sender, message);
+		gnunet_search_pool_release(message);
+
+		current += message_size;
+		payload_size -= message_size;
+	}
+}
 
-	while(queue_get_length(gnunet_search_flooding_message_queue)) {
-		struct gnunet_search_flooding_queued_message *msg =
-				(struct gnunet_search_flooding_queued_message *) queue_dequeue(gnunet_search_flooding_message_queue);
-		GNUNET_free(msg->buffer);
-		GNUNET_free(msg);
+/**
+ * @brief This function sends the cancellation of a flow to the neighbours.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function sends the cancellation of a flow to the neighbours. The cancellation follows the request of the flow; since a peer does not remember
+ * the neighbours it has forwarded a request to the cancellation is sent to all neighbours but the one it has been received from. It is queued with the
+ * priority of responses in order not to be held back for bundling; a neighbour that does not know the flow simply discards it.
+ *
+ * @param sender the neighbour the cancellation has been received from; it is NULL in case the flow originated locally.
+ * @param flow_id the flow id of the flow to cancel
+ * @param ttl the TTL of the cancellation
+ */
+static void gnunet_search_flooding_cancel_forward(struct GNUNET_PeerIdentity const *sender, uint64_t flow_id, uint8_t ttl) {
+	struct gnunet_search_flooding_message flooding_message;
+	flooding_message.flow_id = htobe64(flow_id);
+	flooding_message.ttl = ttl;
+	flooding_message.type = GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_CANCEL;
+	flooding_message.strategy = GNUNET_SEARCH_FORWARDING_DEFAULT;
+	flooding_message.fanout = 0;
+	flooding_message.max_results = 0;
+	flooding_message.flags = 0;
+
+	struct gnunet_search_flooding_buffer *buffer = gnunet_search_flooding_buffer_create(&flooding_message,
+			sizeof(struct gnunet_search_flooding_message));
+	for(unsigned int i = 0; i < gnunet_search_flooding_neighbours_length; ++i) {
+		struct gnunet_search_flooding_neighbour *neighbour = &gnunet_search_flooding_neighbours[i];
+		if(sender && !GNUNET_CRYPTO_hash_cmp(&sender->hashPubKey, &neighbour->identity.hashPubKey))
+			continue;
+		gnunet_search_flooding_neighbour_message_enqueue(neighbour, buffer, GNUNET_SEARCH_FLOODING_PRIORITY_RESPONSE);
 	}
+	gnunet_search_flooding_buffer_release(buffer);
+}
+
+/**
+ * @brief This function computes the query hash of a request.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function computes the query hash of a request. The hash is computed over the normalized keyword of the request (see the normalization
+ * component) so that requests differing only in the spelling of their keyword share the same entry in the result cache; the keyword is hashed
+ * the same way the client communication component hashes the keywords of its in-flight queries.
+ *
+ * @param flooding_message the request
+ * @param flooding_message_size the size of the request
+ * @param query a reference to the memory to store the query hash in
+ */
+static void gnunet_search_flooding_query_get(struct gnunet_search_flooding_message const *flooding_message,
+		size_t flooding_message_size, GNUNET_HashCode *query) {
+	size_t keyword_size = flooding_message_size - sizeof(struct gnunet_search_flooding_message);
+	char *keyword = (char*) GNUNET_malloc(keyword_size + 1);
+	memcpy(keyword, flooding_message + 1, keyword_size);
+	keyword[keyword_size] = 0;
+	gnunet_search_normalization_keyword_normalize(keyword);
+	GNUNET_CRYPTO_hash(keyword, strlen(keyword), query);
+	GNUNET_free(keyword);
 }
 
 /**
@@ -519,13 +2100,23 @@ void gnunet_search_flooding_free() {
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
  * This function processes a message. In case the message is a request it first checks whether the routing table already contains the flow id - in that case the
- * same request has already been seen before and thus has been flooded in a cycle; such a message is discarded. Otherwise the new flow is entered into the routing
- * table. Afterwards the request is passed to the handler that processes the search for the keyword included in the request (see above). Independent of the result
- * of the search the request's TTL is decremented and it is - in case the resulting TTL is greater than zero - flooded to all neighbouring peers; thus a request
- * always either reaches all peers or is discarded because of an exceeded TTL - it is not stopped because of a peer knowing an answer. The reason for that behaviour is that there might
- * be multiple peers with different answers all of which the sender is interested in. In case the message is a response the corresponding entry in the routing table is
+ * same request has already been seen before and thus has been flooded in a cycle; such a message is discarded. Requests received from neighbours are then subject
+ * to rate limiting (see above); a request exceeding the limits is discarded as well. Otherwise the new flow is entered into the routing
+ * table; if the routing table is full the request is discarded as well since its responses could not be routed back. Afterwards the request is passed to the handler that processes the search for the keyword included in the request (see above). Independent of the result
+ * of the search the request's TTL is decremented and it is - in case the resulting TTL is greater than zero - forwarded to the neighbouring peers using the forwarding
+ * strategy chosen by the requestor (see above); a request is not stopped because of a peer knowing an answer. The reason for that behaviour is that there might
+ * be multiple peers with different answers all of which the sender is interested in. There are two exceptions to the cycle detection: a request of a known flow carrying
+ * a higher TTL than seen before (the next ring of an expanding ring search) and a random walker are forwarded without processing the request again. A new request
+ * is also answered from the result cache in case responses to the same request have been relayed before; such a request is forwarded with half of its TTL or not at
+ * all, depending on the configuration. Responses received from neighbours and relayed to other peers are added to the result cache. Results of a response that have already been forwarded
+ * for the same flow are removed; a response without any new result is discarded. Results only count as forwarded once their response has actually been
+ * relayed or delivered; a response dropped because its TTL ran out leaves them to later responses. In case the message is a response the corresponding entry in the routing table is
  * searched. If no entry is found the message is discarded; otherwise the message is either passed to the message notification handler (in case of an answer to a request
- * originating at local node) or forwarded to the next hop according to the entry of the routing table.
+ * originating at local node) or forwarded to the next hop according to the entry of the routing table. A requestor may limit the number of results
+ * it is interested in; once that many distinct results have been forwarded for a flow neither the request nor any further response is forwarded. Requests of known keywords are only forwarded to
+ * neighbours whose keyword summaries match (see above); summary messages received from neighbours are passed to the summary component. The requests of
+ * a bundle are processed one by one. A cancellation is only accepted from the neighbour the request of the flow has been received from; the flow is
+ * marked as cancelled and the cancellation is forwarded along the flow. Requests and responses of a cancelled flow are discarded.
  *
  * @param sender the sender peer of the message; this parameter has to be NULL in case the message is a request originating locally
  * @param message the message to process
@@ -545,55 +2136,184 @@ void gnunet_search_flooding_peer_message_process(struct GNUNET_PeerIdentity cons
 	size_t flooding_message_size = message_size - sizeof(struct GNUNET_MessageHeader);
 	uint64_t flooding_message_flow_id_host = be64toh(flooding_message->flow_id);
 
+	if(flooding_message->flags & GNUNET_SEARCH_FLOODING_MESSAGE_FLAG_COMPRESSED) {
+		gnunet_search_flooding_compressed_message_process(sender, flooding_message, flooding_message_size);
+		return;
+	}
+
 	switch(flooding_message->type) {
 		case GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_REQUEST: {
-			if(gnunet_search_flooding_routing_table_id_contains(flooding_message_flow_id_host)) {
+			if(flooding_message->strategy == GNUNET_SEARCH_FORWARDING_DEFAULT
+					|| flooding_message->strategy >= GNUNET_SEARCH_FLOODING_STRATEGIES_LENGTH)
+				break;
+			struct gnunet_search_flooding_strategy const *strategy =
+					&gnunet_search_flooding_strategies[flooding_message->strategy];
+			unsigned int fanout = flooding_message->fanout ? flooding_message->fanout : 1;
+
+			uint8_t ttl = flooding_message->ttl;
+
+			GNUNET_HashCode query;
+			gnunet_search_flooding_query_get(flooding_message, flooding_message_size, &query);
+
+			struct gnunet_search_routing_table_entry *routing_entry = gnunet_search_routing_table_get(
+					flooding_message_flow_id_host);
+			if(routing_entry && memcmp(&routing_entry->query, &query, sizeof(GNUNET_HashCode))) {
+				GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# flow id collisions"), 1,
+						GNUNET_NO);
+				break;
+			}
+			if(routing_entry && routing_entry->cancelled)
+				break;
+			if(routing_entry && flooding_message->ttl <= routing_entry->ttl && !strategy->duplicates_forward) {
 //				printf("Message cycle; discarding...\n");
 				break;
 			}
 
-			gnunet_search_flooding_routing_table[gnunet_search_flooding_routing_table_index].flow_id =
-					flooding_message_flow_id_host;
-			gnunet_search_flooding_routing_table[gnunet_search_flooding_routing_table_index].own_request = sender
-					== NULL;
-			if(!gnunet_search_flooding_routing_table[gnunet_search_flooding_routing_table_index].own_request)
-				memcpy(&gnunet_search_flooding_routing_table[gnunet_search_flooding_routing_table_index].next_hop,
-						sender, sizeof(struct GNUNET_PeerIdentity));
-			gnunet_search_flooding_routing_table_index = (gnunet_search_flooding_routing_table_index + 1)
-					% GNUNET_SEARCH_FLOODING_ROUTING_TABLE_SIZE;
-			if(gnunet_search_flooding_routing_table_length < GNUNET_SEARCH_FLOODING_ROUTING_TABLE_SIZE)
-				gnunet_search_flooding_routing_table_length++;
-
-			if(_gnunet_search_flooding_message_notification_handler)
-				_gnunet_search_flooding_message_notification_handler(sender, flooding_message, flooding_message_size);
-
-			struct gnunet_search_flooding_message *output_flooding_message =
-					(struct gnunet_search_flooding_message *) GNUNET_malloc(flooding_message_size);
-			memcpy(output_flooding_message, flooding_message, flooding_message_size);
-			output_flooding_message->ttl--;
-			if(output_flooding_message->ttl > 0)
-				gnunet_search_flooding_data_flood(sender, output_flooding_message, flooding_message_size);
+			if(sender && !gnunet_search_flooding_request_admit(sender))
+				break;
+
+			if(routing_entry) {
+				if(flooding_message->ttl > routing_entry->ttl)
+					routing_entry->ttl = flooding_message->ttl;
+			} else {
+				routing_entry = gnunet_search_routing_table_add(flooding_message_flow_id_host);
+				if(!routing_entry)
+					break;
+				routing_entry->requester =
+						sender ? GNUNET_SEARCH_ROUTING_TABLE_REQUESTER_NEIGHBOUR : GNUNET_SEARCH_ROUTING_TABLE_REQUESTER_LOCAL;
+				if(sender)
+					memcpy(&routing_entry->next_hop, sender, sizeof(struct GNUNET_PeerIdentity));
+				routing_entry->ttl = flooding_message->ttl;
+				routing_entry->max_results = ntohs(flooding_message->max_results);
+				memcpy(&routing_entry->query, &query, sizeof(GNUNET_HashCode));
+
+				if(_gnunet_search_flooding_message_notification_handler)
+					_gnunet_search_flooding_message_notification_handler(sender, flooding_message,
+							flooding_message_size);
+
+				void *cached;
+				size_t cached_size = gnunet_search_result_cache_get(&query, &cached);
+				if(cached_size) {
+					GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# result cache hits"), 1,
+							GNUNET_NO);
+					gnunet_search_flooding_peer_response_send(cached, cached_size, flooding_message_flow_id_host);
+					GNUNET_free(cached);
+					ttl = gnunet_search_flooding_cache_hit_forward ? ttl / 2 : 0;
+				}
+
+				if(!sender && flooding_message->strategy != GNUNET_SEARCH_FORWARDING_WALK)
+					gnunet_search_flooding_ring_start(flooding_message_flow_id_host, flooding_message,
+							flooding_message_size);
+			}
+
+			if(ttl <= 1)
+				break;
+			if(routing_entry->max_results && routing_entry->results >= routing_entry->max_results) {
+				GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# requests stopped at result limit"),
+						1, GNUNET_NO);
+				break;
+			}
+
+			enum gnunet_search_flooding_priority priority =
+					sender ? GNUNET_SEARCH_FLOODING_PRIORITY_RELAYED_REQUEST : GNUNET_SEARCH_FLOODING_PRIORITY_LOCAL_REQUEST;
+			struct gnunet_search_flooding_buffer *output_buffer = gnunet_search_flooding_buffer_create(flooding_message,
+					flooding_message_size);
+			gnunet_search_flooding_buffer_flooding_message_get(output_buffer)->ttl = ttl - 1;
+
+			routing_entry->forwarded = GNUNET_TIME_absolute_get();
+			uint8_t summary_forwarded = 0;
+			char const *keyword = (char const*) (flooding_message + 1);
+			if(gnunet_search_flooding_summary_routing && flooding_message->strategy != GNUNET_SEARCH_FORWARDING_WALK
+					&& memchr(keyword, 0, flooding_message_size - sizeof(struct gnunet_search_flooding_message))) {
+				GNUNET_HashCode keyword_hash;
+				gnunet_search_summary_keyword_hash(keyword, &keyword_hash);
+				summary_forwarded = gnunet_search_flooding_summary_forward(sender, output_buffer, priority, routing_entry,
+						&keyword_hash, ttl - 1);
+			}
+			if(!summary_forwarded)
+				strategy->forward(sender, output_buffer, priority, fanout, routing_entry);
+			if(!sender && flooding_message->strategy == GNUNET_SEARCH_FORWARDING_WALK)
+				gnunet_search_flooding_walk_start(flooding_message_flow_id_host, output_buffer, fanout);
+			gnunet_search_flooding_buffer_release(output_buffer);
 			break;
 		}
 		case GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_RESPONSE: {
-			size_t next_hop_index;
-			uint8_t found = gnunet_search_flooding_routing_table_id_get_next_hop_index(&next_hop_index,
+			struct gnunet_search_routing_table_entry *routing_entry = gnunet_search_routing_table_get(
 					flooding_message_flow_id_host);
-			if(!found) {
+			if(!routing_entry) {
 //				printf("Unknown flow; aborting...\n");
 				break;
 			}
-			if(gnunet_search_flooding_routing_table[next_hop_index].own_request) {
+			if(routing_entry->cancelled) {
+				GNUNET_STATISTICS_update(gnunet_search_globals_statistics,
+						gettext_noop("# responses dropped for cancelled flows"), 1, GNUNET_NO);
+				routing_entry->responses_dropped++;
+				break;
+			}
+
+			char const *results = (char const*) (flooding_message + 1);
+			size_t results_size = flooding_message_size - sizeof(struct gnunet_search_flooding_message);
+
+			/*
+			 * Security, data from network
+			 */
+			if(!results_size || results[results_size - 1]) {
+				GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# empty responses dropped"), 1,
+						GNUNET_NO);
+				routing_entry->responses_dropped++;
+				break;
+			}
+
+			/*
+			 * Responses generated locally (cache hits and answers from the local storage) are not cached; otherwise a cached
+			 * answer would keep renewing itself.
+			 */
+			if(sender && routing_entry->requester == GNUNET_SEARCH_ROUTING_TABLE_REQUESTER_NEIGHBOUR)
+				gnunet_search_result_cache_add(&routing_entry->query, results, results_size);
+
+			if(routing_entry->max_results && routing_entry->results >= routing_entry->max_results) {
+				GNUNET_STATISTICS_update(gnunet_search_globals_statistics,
+						gettext_noop("# responses dropped at result limit"), 1, GNUNET_NO);
+				routing_entry->responses_dropped++;
+				break;
+			}
+
+			struct gnunet_search_flooding_message *filtered_message =
+					(struct gnunet_search_flooding_message*) gnunet_search_pool_allocate(flooding_message_size);
+			memcpy(filtered_message, flooding_message, sizeof(struct gnunet_search_flooding_message));
+			size_t filtered_size = gnunet_search_flooding_results_filter(routing_entry, results, results_size,
+					(char*) (filtered_message + 1));
+			if(!filtered_size) {
+				GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# empty responses dropped"), 1,
+						GNUNET_NO);
+				routing_entry->responses_dropped++;
+				gnunet_search_pool_release(filtered_message);
+				break;
+			}
+			if(sender)
+				gnunet_search_flooding_rank_response_record(sender, routing_entry, (char const*) (filtered_message + 1),
+						filtered_size);
+			routing_entry->responses++;
+
+			if(routing_entry->requester != GNUNET_SEARCH_ROUTING_TABLE_REQUESTER_LOCAL && flooding_message->ttl <= 1) {
+				GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# responses dropped at TTL"), 1,
+						GNUNET_NO);
+				routing_entry->responses_dropped++;
+				gnunet_search_pool_release(filtered_message);
+				break;
+			}
+			filtered_size = gnunet_search_flooding_results_limit(routing_entry, (char const*) (filtered_message + 1),
+					filtered_size);
+			size_t filtered_message_size = sizeof(struct gnunet_search_flooding_message) + filtered_size;
+			gnunet_search_flooding_results_mark(routing_entry, (char const*) (filtered_message + 1), filtered_size);
+
+			if(routing_entry->requester == GNUNET_SEARCH_ROUTING_TABLE_REQUESTER_LOCAL) {
 //				printf("Yippie, this is response to my request :-).\n");
 				if(_gnunet_search_flooding_message_notification_handler)
-					_gnunet_search_flooding_message_notification_handler(sender, flooding_message,
-							flooding_message_size);
+					_gnunet_search_flooding_message_notification_handler(sender, filtered_message,
+							filtered_message_size);
 			} else {
-				struct GNUNET_PeerIdentity const *next_hop =
-						&gnunet_search_flooding_routing_table[next_hop_index].next_hop;
-				struct gnunet_search_flooding_message *output_flooding_message =
-						(struct gnunet_search_flooding_message *) GNUNET_malloc(flooding_message_size);
-				memcpy(output_flooding_message, flooding_message, flooding_message_size);
+				struct GNUNET_PeerIdentity const *next_hop = &routing_entry->next_hop;
 
 //				printf("Relaying answer to original sender of request...\n");
 //				struct GNUNET_CRYPTO_HashAsciiEncoded result;
@@ -602,12 +2322,44 @@ void gnunet_search_flooding_peer_message_process(struct GNUNET_PeerIdentity cons
 //				GNUNET_CRYPTO_hash_to_enc(&next_hop->hashPubKey, &result);
 //				printf("Relaying to peer: %.*s...\n", 104, (char*) &result);
 
-				output_flooding_message->ttl--;
-				if(output_flooding_message->ttl > 0)
-					gnunet_search_flooding_to_peer_message_send(next_hop, output_flooding_message,
-							flooding_message_size);
-				GNUNET_free(output_flooding_message);
+				struct gnunet_search_flooding_buffer *output_buffer = gnunet_search_flooding_buffer_create(
+						filtered_message, filtered_message_size);
+				gnunet_search_flooding_buffer_flooding_message_get(output_buffer)->ttl--;
+				gnunet_search_flooding_to_peer_message_send(next_hop, output_buffer,
+						GNUNET_SEARCH_FLOODING_PRIORITY_RESPONSE);
+				gnunet_search_flooding_buffer_release(output_buffer);
 			}
+			gnunet_search_pool_release(filtered_message);
+			break;
+		}
+		case GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_BUNDLE: {
+			if(sender)
+				gnunet_search_flooding_bundle_process(sender, flooding_message + 1,
+						flooding_message_size - sizeof(struct gnunet_search_flooding_message));
+			break;
+		}
+		case GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_SUMMARY: {
+			if(sender)
+				gnunet_search_summary_message_process(sender, flooding_message + 1,
+						flooding_message_size - sizeof(struct gnunet_search_flooding_message));
+			break;
+		}
+		case GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_CANCEL: {
+			if(!sender)
+				break;
+			struct gnunet_search_routing_table_entry *routing_entry = gnunet_search_routing_table_get(
+					flooding_message_flow_id_host);
+			if(!routing_entry || routing_entry->cancelled
+					|| routing_entry->requester != GNUNET_SEARCH_ROUTING_TABLE_REQUESTER_NEIGHBOUR
+					|| GNUNET_CRYPTO_hash_cmp(&sender->hashPubKey, &routing_entry->next_hop.hashPubKey))
+				break;
+
+			GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# flows cancelled by requestor"), 1,
+					GNUNET_NO);
+			routing_entry->cancelled = 1;
+			if(flooding_message->ttl > 1)
+				gnunet_search_flooding_cancel_forward(sender, flooding_message_flow_id_host, flooding_message->ttl - 1);
+			break;
 		}
 	}
 }
@@ -622,19 +2374,23 @@ void gnunet_search_flooding_peer_local_message_process(struct GNUNET_MessageHead
 }
 
 /**
- * @brief This function sends data originating locally either by flooding (in case of a request) or by forwarding (in case of a response).
+ * @brief This function sends a message originating locally.
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This function sends data originating locally either by flooding (in case of a request) or by forwarding (in case of a response). It therefore
- * prepends the GNUnet message header and the flooding message header.
+ * This function sends a message originating locally. It therefore prepends the GNUnet message header and the flooding message header. In case no
+ * forwarding strategy or fanout is given the configured defaults are used.
  *
  * @param data the data so send
  * @param data_size the size of the data; the caller should care about the maximal possible size using the GNUNET_SEARCH_FLOODING_MESSAGE_MAXIMAL_PAYLOAD_SIZE constant.
  * @param type the type of the message - either GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_REQUEST or GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_RESPONSE
  * @param flow_id the flow id to use
+ * @param strategy the forwarding strategy - one of the GNUNET_SEARCH_FORWARDING_* constants
+ * @param fanout the fanout of the forwarding strategy or 0
+ * @param max_results the maximal number of results requested or 0
  */
-void gnunet_search_flooding_peer_data_send(void const *data, size_t data_size, uint8_t type, uint64_t flow_id) {
+static void gnunet_search_flooding_message_send(void const *data, size_t data_size, uint8_t type, uint64_t flow_id,
+		uint8_t strategy, uint8_t fanout, uint16_t max_results) {
 	size_t message_total_size = sizeof(struct GNUNET_MessageHeader) + sizeof(struct gnunet_search_flooding_message)
 			+ data_size;
 
@@ -642,7 +2398,7 @@ void gnunet_search_flooding_peer_data_send(void const *data, size_t data_size, u
 	if(message_total_size > GNUNET_SERVER_MAX_MESSAGE_SIZE)
 		return;
 
-	void *buffer = GNUNET_malloc(message_total_size);
+	void *buffer = gnunet_search_pool_allocate(message_total_size);
 
 	struct GNUNET_MessageHeader *message = (struct GNUNET_MessageHeader *) buffer;
 	message->size = htons((uint16_t) message_total_size);
@@ -650,14 +2406,92 @@ void gnunet_search_flooding_peer_data_send(void const *data, size_t data_size, u
 
 	struct gnunet_search_flooding_message *flooding_message = (struct gnunet_search_flooding_message*) (message + 1);
 	flooding_message->flow_id = htobe64(flow_id);
-	flooding_message->ttl = 16;
 	flooding_message->type = type;
+	if(strategy == GNUNET_SEARCH_FORWARDING_DEFAULT || strategy >= GNUNET_SEARCH_FLOODING_STRATEGIES_LENGTH)
+		strategy = gnunet_search_flooding_strategy_default;
+	if(type == GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_RESPONSE)
+		flooding_message->ttl = gnunet_search_flooding_ttl_limit;
+	else if(strategy == GNUNET_SEARCH_FORWARDING_WALK)
+		flooding_message->ttl = gnunet_search_flooding_ttl_maximum;
+	else
+		flooding_message->ttl = GNUNET_MIN(gnunet_search_flooding_ring_ttl_initial, gnunet_search_flooding_ttl_maximum);
+	flooding_message->strategy = strategy;
+	flooding_message->fanout = fanout ? fanout : gnunet_search_flooding_fanout_default;
+	flooding_message->max_results = htons(max_results);
+	flooding_message->flags = 0;
 
 	memcpy(flooding_message + 1, data, data_size);
 
 	gnunet_search_flooding_peer_local_message_process(message);
 
-	GNUNET_free(buffer);
+	gnunet_search_pool_release(buffer);
+}
+
+/**
+ * @brief This function sends a summary message to a neighbour.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function sends a summary message to a neighbour. Summary messages are not forwarded by the neighbour; they are queued with the priority of
+ * responses since a lost summary degrades the forwarding decisions until the next full summary is sent.
+ *
+ * @param peer the neighbour to send the message to
+ * @param data the summary message (see the summary component)
+ * @param data_size the size of the summary message
+ */
+void gnunet_search_flooding_peer_summary_send(struct GNUNET_PeerIdentity const *peer, void const *data, size_t data_size) {
+	size_t flooding_message_size = sizeof(struct gnunet_search_flooding_message) + data_size;
+	GNUNET_assert(data_size <= GNUNET_SEARCH_FLOODING_MESSAGE_MAXIMAL_PAYLOAD_SIZE);
+
+	struct gnunet_search_flooding_message *flooding_message = (struct gnunet_search_flooding_message*) gnunet_search_pool_allocate(
+			flooding_message_size);
+	flooding_message->flow_id = 0;
+	flooding_message->ttl = 1;
+	flooding_message->type = GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_SUMMARY;
+	flooding_message->strategy = GNUNET_SEARCH_FORWARDING_DEFAULT;
+	flooding_message->fanout = 0;
+	flooding_message->max_results = 0;
+	flooding_message->flags = 0;
+	memcpy(flooding_message + 1, data, data_size);
+
+	struct gnunet_search_flooding_buffer *buffer = gnunet_search_flooding_buffer_create(flooding_message,
+			flooding_message_size);
+	gnunet_search_pool_release(flooding_message);
+	gnunet_search_flooding_to_peer_message_send(peer, buffer, GNUNET_SEARCH_FLOODING_PRIORITY_RESPONSE);
+	gnunet_search_flooding_buffer_release(buffer);
+}
+
+/**
+ * @brief This function sends data originating locally either by flooding (in case of a request) or by forwarding (in case of a response).
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function sends data originating locally either by flooding (in case of a request) or by forwarding (in case of a response). Requests are
+ * forwarded using the configured forwarding strategy.
+ *
+ * @param data the data so send
+ * @param data_size the size of the data; the caller should care about the maximal possible size using the GNUNET_SEARCH_FLOODING_MESSAGE_MAXIMAL_PAYLOAD_SIZE constant.
+ * @param type the type of the message - either GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_REQUEST or GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_RESPONSE
+ * @param flow_id the flow id to use
+ */
+void gnunet_search_flooding_peer_data_send(void const *data, size_t data_size, uint8_t type, uint64_t flow_id) {
+	gnunet_search_flooding_message_send(data, data_size, type, flow_id, GNUNET_SEARCH_FORWARDING_DEFAULT, 0, 0);
+}
+
+/**
+ * @brief This function sends a request originating locally using a given forwarding strategy.
+ *
+ * @param data the data to send
+ * @param data_size the size of the data; the caller should care about the maximal possible size using the GNUNET_SEARCH_FLOODING_MESSAGE_MAXIMAL_PAYLOAD_SIZE constant.
+ * @param flow_id the flow id to use
+ * @param strategy the forwarding strategy - one of the GNUNET_SEARCH_FORWARDING_* constants; GNUNET_SEARCH_FORWARDING_DEFAULT selects the configured strategy
+ * @param fanout the fanout of the forwarding strategy; 0 selects the configured fanout
+ * @param max_results the maximal number of results requested; 0 requests all results
+ */
+void gnunet_search_flooding_peer_request_send(void const *data, size_t data_size, uint64_t flow_id, uint8_t strategy,
+		uint8_t fanout, uint16_t max_results) {
+	gnunet_search_flooding_message_send(data, data_size, GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_REQUEST, flow_id, strategy,
+			fanout, max_results);
 }
 
 /**
@@ -668,7 +2502,86 @@ void gnunet_search_flooding_peer_data_send(void const *data, size_t data_size, u
  */
 void gnunet_search_flooding_peer_request_flood(void const *data, size_t data_size) {
 	gnunet_search_flooding_peer_data_send(data, data_size, GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_REQUEST,
-			((uint64_t) rand() << 32) | rand());
+			gnunet_search_flooding_flow_id_generate());
+}
+
+/**
+ * @brief This function generates the flow id of a new flow originating locally.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function generates the flow id of a new flow originating locally. Flow ids have to be unique across all peers and restarts since a
+ * request whose flow id is already known is discarded as a cycle; they are thus drawn uniformly from the full 64 bit range using the GNUnet
+ * random number generator. The flow id 0 is reserved for messages not belonging to a flow and ids of flows known locally are skipped.
+ *
+ * @return the flow id
+ */
+uint64_t gnunet_search_flooding_flow_id_generate() {
+	uint64_t flow_id;
+	do
+		flow_id = GNUNET_CRYPTO_random_u64(GNUNET_CRYPTO_QUALITY_NONCE, UINT64_MAX);
+	while(!flow_id || gnunet_search_routing_table_get(flow_id));
+	return flow_id;
+}
+
+/**
+ * @brief This function cancels a flow originating locally.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function cancels a flow originating locally. The flow is marked as cancelled in the routing table; responses arriving later are dropped.
+ * Expanding ring searches and random walks of the flow are stopped as well. A cancellation is sent along the flow so that the peers relaying it
+ * stop forwarding the request and its responses (see above).
+ *
+ * @param flow_id the flow id of the flow to cancel
+ */
+void gnunet_search_flooding_flow_cancel(uint64_t flow_id) {
+	struct gnunet_search_routing_table_entry *routing_entry = gnunet_search_routing_table_get(flow_id);
+	if(!routing_entry || routing_entry->requester != GNUNET_SEARCH_ROUTING_TABLE_REQUESTER_LOCAL
+			|| routing_entry->cancelled)
+		return;
+
+	GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# flows cancelled"), 1, GNUNET_NO);
+	routing_entry->cancelled = 1;
+	if(routing_entry->ttl > 1)
+		gnunet_search_flooding_cancel_forward(NULL, flow_id, routing_entry->ttl - 1);
+
+	struct gnunet_search_flooding_ring *ring = gnunet_search_flooding_rings_head;
+	while(ring) {
+		struct gnunet_search_flooding_ring *next = ring->next;
+		if(ring->flow_id == flow_id)
+			gnunet_search_flooding_ring_free(ring);
+		ring = next;
+	}
+	struct gnunet_search_flooding_walk *walk = gnunet_search_flooding_walks_head;
+	while(walk) {
+		struct gnunet_search_flooding_walk *next = walk->next;
+		if(walk->flow_id == flow_id)
+			gnunet_search_flooding_walk_free(walk);
+		walk = next;
+	}
+}
+
+/**
+ * @brief This function records results of a flow originating locally that have been delivered to the client without being received from the network.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function records results of a flow originating locally that have been delivered to the client without being received from the network, e.g.
+ * results found in the local storage. The results are recorded as forwarded for the flow; responses carrying them are thus discarded as duplicates.
+ * They do not count towards the result limit of the flow since the requestor has already deducted them from the limit of the request.
+ *
+ * @param flow_id the flow id
+ * @param results the results; every result is terminated by a zero byte.
+ * @param results_size the size of the results
+ */
+void gnunet_search_flooding_flow_results_record(uint64_t flow_id, void const *results, size_t results_size) {
+	struct gnunet_search_routing_table_entry *routing_entry = gnunet_search_routing_table_get(flow_id);
+	if(!routing_entry || routing_entry->requester != GNUNET_SEARCH_ROUTING_TABLE_REQUESTER_LOCAL || !results_size
+			|| ((char const*) results)[results_size - 1])
+		return;
+
+	gnunet_search_flooding_results_mark(routing_entry, (char const*) results, results_size);
 }
 
 /**
@@ -681,3 +2594,35 @@ void gnunet_search_flooding_peer_request_flood(void const *data, size_t data_siz
 void gnunet_search_flooding_peer_response_send(void const *data, size_t data_size, uint64_t flow_id) {
 	gnunet_search_flooding_peer_data_send(data, data_size, GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_RESPONSE, flow_id);
 }
+
+/**
+ * @brief This function tests whether the local peer is among the peers closest to a given key.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function tests whether the local peer is among the peers closest to a given key. The distance is the XOR distance between the key
+ * and the peers' identities; the local peer is compared with all peers in the neighbour table. In case the identity of the local peer is
+ * not yet known the function assumes the local peer to be among the closest peers.
+ *
+ * Note that closeness is only decided from the local view of the overlay: a peer whose neighbours are all farther from the key than itself
+ * considers itself responsible even if closer peers exist elsewhere in the network. The number of peers considering themselves among the k
+ * closest is thus only roughly k; it may be higher in sparse neighbourhoods and lower in case the closest peers are not connected to each
+ * other. The DHT service would know the peers actually closest to the key, but its client API does not expose the peers a put has been
+ * replicated to.
+ *
+ * @param key the key to test
+ * @param k the number of closest peers
+ *
+ * @return a boolean value indicating whether less than k neighbours are closer to the key than the local peer (1) or not (0)
+ */
+uint8_t gnunet_search_flooding_closest_peers_contains_self(GNUNET_HashCode const *key, unsigned int k) {
+	if(!gnunet_search_flooding_identity_known)
+		return 1;
+
+	unsigned int closer = 0;
+	for(unsigned int i = 0; i < gnunet_search_flooding_neighbours_length && closer < k; ++i)
+		if(GNUNET_CRYPTO_hash_xorcmp(&gnunet_search_flooding_neighbours[i].identity.hashPubKey,
+				&gnunet_search_flooding_identity.hashPubKey, key) < 0)
+			closer++;
+	return closer < k;
+}
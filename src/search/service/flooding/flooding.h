@@ -32,10 +32,6 @@
 #include <gnunet/gnunet_util_lib.h>
 #include <gnunet/gnunet_core_service.h>
 
-/**
- * @brief This constant defines the size of the routing table.
- */
-#define GNUNET_SEARCH_FLOODING_ROUTING_TABLE_SIZE 25
 /**
  * @brief This constant defines a numerical code used used in a flooding message to define it as a request message.
  */
@@ -44,6 +40,25 @@
  * @brief This constant defines a numerical code used used in a flooding message to define it as a response message.
  */
 #define GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_RESPONSE 1
+/**
+ * @brief This constant defines a numerical code used used in a flooding message to define it as a summary message exchanged between neighbours.
+ */
+#define GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_SUMMARY 2
+/**
+ * @brief This constant defines a numerical code used used in a flooding message to define it as a bundle of requests sent to a neighbour; the payload
+ * of a bundle consists of complete GNUnet messages each containing a request.
+ */
+#define GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_BUNDLE 3
+/**
+ * @brief This constant defines a numerical code used used in a flooding message to define it as a cancellation of a flow; it is sent along the flow
+ * by the requestor and carries no payload.
+ */
+#define GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_CANCEL 4
+
+/**
+ * @brief This constant defines a flag used in a flooding message to indicate that the payload is encoded by the compression component.
+ */
+#define GNUNET_SEARCH_FLOODING_MESSAGE_FLAG_COMPRESSED (1 << 0)
 
 /**
  * @brief This constant defines the maximal usable payload size for a flooding message.
@@ -79,6 +94,22 @@ struct __attribute__((__packed__)) gnunet_search_flooding_message {
 	 * @brief This member stores the type of the message - either GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_REQUEST or GNUNET_SEARCH_FLOODING_MESSAGE_TYPE_RESPONSE.
 	 */
 	uint8_t type;
+	/**
+	 * @brief This member stores the forwarding strategy chosen by the requestor - one of the GNUNET_SEARCH_FORWARDING_* constants.
+	 */
+	uint8_t strategy;
+	/**
+	 * @brief This member stores the fanout of the forwarding strategy chosen by the requestor.
+	 */
+	uint8_t fanout;
+	/**
+	 * @brief This member stores the maximal number of distinct results the requestor is interested in; 0 means no limit. It is stored in network byte order.
+	 */
+	uint16_t max_results;
+	/**
+	 * @brief This member stores the flags of the message - a combination of the GNUNET_SEARCH_FLOODING_MESSAGE_FLAG_* constants.
+	 */
+	uint8_t flags;
 };
 
 extern void gnunet_search_flooding_init();
@@ -87,8 +118,16 @@ extern void gnunet_search_flooding_peer_message_process(struct GNUNET_PeerIdenti
 		struct GNUNET_MessageHeader const *message);
 extern void gnunet_search_flooding_peer_local_message_process(struct GNUNET_MessageHeader const *message);
 extern void gnunet_search_flooding_peer_request_flood(void const *data, size_t data_size);
+extern uint64_t gnunet_search_flooding_flow_id_generate();
+extern void gnunet_search_flooding_flow_cancel(uint64_t flow_id);
+extern void gnunet_search_flooding_flow_results_record(uint64_t flow_id, void const *results, size_t results_size);
+extern void gnunet_search_flooding_peer_request_send(void const *data, size_t data_size, uint64_t flow_id, uint8_t strategy,
+		uint8_t fanout, uint16_t max_results);
 extern void gnunet_search_flooding_peer_response_send(void const *data, size_t data_size, uint64_t flow_id);
+extern void gnunet_search_flooding_peer_summary_send(struct GNUNET_PeerIdentity const *peer, void const *data,
+		size_t data_size);
 extern void gnunet_search_flooding_peer_data_send(void const *data, size_t data_size, uint8_t type, uint64_t flow_id);
+extern uint8_t gnunet_search_flooding_closest_peers_contains_self(GNUNET_HashCode const *key, unsigned int k);
 //extern void gnunet_search_handlers_set(
 //		void (*message_notification_handler)(struct GNUNET_PeerIdentity const *, struct gnunet_search_flooding_message *,
 //				size_t size));
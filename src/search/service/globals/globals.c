@@ -27,9 +27,69 @@
  *  along with GNUnet Search.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <gnunet/platform.h>
+#include <gnunet/gnunet_util_lib.h>
+
 #include "globals.h"
 
 /**
  * @brief This variable stores a reference to the GNUnet configuration.
  */
 struct GNUNET_CONFIGURATION_Handle const *gnunet_search_globals_cfg;
+/**
+ * @brief This variable stores a reference to the GNUnet statistics handle used to expose the service's metrics.
+ */
+struct GNUNET_STATISTICS_Handle *gnunet_search_globals_statistics;
+
+/**
+ * @brief This function reads a numerical option from the service's configuration section.
+ *
+ * @param option the name of the option
+ * @param default_value the value to use in case the option is not set
+ *
+ * @return the configured value or the default value
+ */
+unsigned long long gnunet_search_globals_config_number_get(char const *option, unsigned long long default_value) {
+	unsigned long long value;
+	if(GNUNET_OK != GNUNET_CONFIGURATION_get_value_number(gnunet_search_globals_cfg,
+			GNUNET_SEARCH_GLOBALS_CONFIG_SECTION, option, &value))
+		return default_value;
+	return value;
+}
+
+/**
+ * @brief This function reads a time option from the service's configuration section.
+ *
+ * @param option the name of the option
+ * @param default_value the value to use in case the option is not set
+ *
+ * @return the configured value or the default value
+ */
+struct GNUNET_TIME_Relative gnunet_search_globals_config_time_get(char const *option,
+		struct GNUNET_TIME_Relative default_value) {
+	struct GNUNET_TIME_Relative value;
+	if(GNUNET_OK != GNUNET_CONFIGURATION_get_value_time(gnunet_search_globals_cfg,
+			GNUNET_SEARCH_GLOBALS_CONFIG_SECTION, option, &value))
+		return default_value;
+	return value;
+}
+
+/**
+ * @brief This function reads an option from the service's configuration section that has to be one of a given set of choices.
+ *
+ * @param option the name of the option
+ * @param choices the NULL-terminated list of valid choices
+ * @param default_index the index of the choice to use in case the option is not set or invalid
+ *
+ * @return the index of the configured choice or the default index
+ */
+unsigned int gnunet_search_globals_config_choice_get(char const *option, char const **choices, unsigned int default_index) {
+	char const *value;
+	if(GNUNET_OK != GNUNET_CONFIGURATION_get_value_choice(gnunet_search_globals_cfg,
+			GNUNET_SEARCH_GLOBALS_CONFIG_SECTION, option, choices, &value))
+		return default_index;
+	for(unsigned int i = 0; choices[i]; ++i)
+		if(choices[i] == value)
+			return i;
+	return default_index;
+}
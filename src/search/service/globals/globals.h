@@ -27,7 +27,21 @@
 #define GLOBALS_H_
 
 #include <gnunet/platform.h>
+#include <gnunet/gnunet_util_lib.h>
+#include <gnunet/gnunet_statistics_service.h>
+
+/**
+ * @brief This constant defines the name of the configuration section all options of the service are read from.
+ */
+#define GNUNET_SEARCH_GLOBALS_CONFIG_SECTION "search"
 
 extern struct GNUNET_CONFIGURATION_Handle const *gnunet_search_globals_cfg;
+extern struct GNUNET_STATISTICS_Handle *gnunet_search_globals_statistics;
+
+extern unsigned long long gnunet_search_globals_config_number_get(char const *option, unsigned long long default_value);
+extern struct GNUNET_TIME_Relative gnunet_search_globals_config_time_get(char const *option,
+		struct GNUNET_TIME_Relative default_value);
+extern unsigned int gnunet_search_globals_config_choice_get(char const *option, char const **choices,
+		unsigned int default_index);
 
 #endif /* GLOBALS_H_ */
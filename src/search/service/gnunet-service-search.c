@@ -29,6 +29,7 @@
 
 #include <gnunet/platform.h>
 #include <gnunet/gnunet_util_lib.h>
+#include <gnunet/gnunet_statistics_service.h>
 
 #include "service/util/service-util.h"
 #include "service/client-communication/client-communication.h"
@@ -36,6 +37,10 @@
 #include "flooding/flooding.h"
 #include "storage/storage.h"
 #include "globals/globals.h"
+#include "url-processor/url-processor.h"
+#include "result-cache/result-cache.h"
+#include "summary/summary.h"
+#include "communication/pool.h"
 
 /**
  * @brief This function handles the shutdown of the application.
@@ -45,9 +50,15 @@
  */
 static void gnunet_search_shutdown_task(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc) {
 	gnunet_search_dht_free();
+	gnunet_search_url_processor_free();
 	gnunet_search_client_communication_free();
 	gnunet_search_flooding_free();
+	gnunet_search_result_cache_free();
+	gnunet_search_summary_free();
 	gnunet_search_storage_free();
+	gnunet_search_pool_free();
+
+	GNUNET_STATISTICS_destroy(gnunet_search_globals_statistics, GNUNET_NO);
 
 	//GNUNET_CONFIGURATION_destroy(gnunet_search_globals_cfg);
 
@@ -67,11 +78,15 @@ static void gnunet_search_shutdown_task(void *cls, const struct GNUNET_SCHEDULER
  */
 static void gnunet_search_service_run(void *cls, struct GNUNET_SERVER_Handle *server, const struct GNUNET_CONFIGURATION_Handle *cfg) {
 	gnunet_search_globals_cfg = cfg;
+	gnunet_search_globals_statistics = GNUNET_STATISTICS_create("search", cfg);
 
 	gnunet_search_client_communication_init(server);
 
 	gnunet_search_storage_init();
+	gnunet_search_summary_init();
+	gnunet_search_url_processor_init();
 	gnunet_search_dht_init();
+	gnunet_search_result_cache_init();
 	gnunet_search_flooding_init();
 
 	GNUNET_SCHEDULER_add_delayed(GNUNET_TIME_UNIT_FOREVER_REL, &gnunet_search_shutdown_task, NULL);
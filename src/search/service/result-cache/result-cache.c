@@ -0,0 +1,268 @@
+/**
+ * @file search/service/result-cache/result-cache.c
+ * @author Julian Kranz
+ * @date 18.10.2026
+ *
+ * @brief This file contains all functions pertaining to the GNUnet Search service's result cache component.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This file contains all functions pertaining to the GNUnet Search service's result cache component. This component stores the URLs of
+ * responses relayed by the local peer keyed by the hash of the normalized keyword they answer. The cached URL sets expire after a configurable lifetime;
+ * the memory used by the cache is bounded and the least recently used entries are evicted first.
+ */
+/*
+ *  This file is part of GNUnet Search.
+ *
+ *  GNUnet Search is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  GNUnet Search is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNUnet Search.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <gnunet/platform.h>
+#include <gnunet/gnunet_util_lib.h>
+
+#include "../globals/globals.h"
+#include "../flooding/flooding.h"
+#include "result-cache.h"
+
+/**
+ * @brief This constant defines the default maximal number of bytes used by the result cache.
+ */
+#define GNUNET_SEARCH_RESULT_CACHE_SIZE_DEFAULT (1024*1024)
+/**
+ * @brief This constant defines the default lifetime of a cached URL set.
+ */
+#define GNUNET_SEARCH_RESULT_CACHE_LIFETIME_DEFAULT GNUNET_TIME_relative_multiply(GNUNET_TIME_UNIT_MINUTES, 10)
+
+/**
+ * @brief This data structure represents an entry of the result cache.
+ */
+struct gnunet_search_result_cache_entry {
+	/**
+	 * @brief This member stores a reference to the previous (more recently used) entry.
+	 */
+	struct gnunet_search_result_cache_entry *prev;
+	/**
+	 * @brief This member stores a reference to the next (less recently used) entry.
+	 */
+	struct gnunet_search_result_cache_entry *next;
+	/**
+	 * @brief This member stores the hash of the request the URLs answer.
+	 */
+	GNUNET_HashCode query;
+	/**
+	 * @brief This member stores the time the entry expires.
+	 */
+	struct GNUNET_TIME_Absolute expiration;
+	/**
+	 * @brief This member stores the URLs; every URL is terminated by a zero byte.
+	 */
+	char *data;
+	/**
+	 * @brief This member stores the size of the URL data.
+	 */
+	size_t data_size;
+};
+
+/**
+ * @brief This variable stores a reference to the map from request hashes to cache entries.
+ */
+static struct GNUNET_CONTAINER_MultiHashMap *gnunet_search_result_cache_map;
+/**
+ * @brief This variable stores a reference to the most recently used entry.
+ */
+static struct gnunet_search_result_cache_entry *gnunet_search_result_cache_head;
+/**
+ * @brief This variable stores a reference to the least recently used entry.
+ */
+static struct gnunet_search_result_cache_entry *gnunet_search_result_cache_tail;
+/**
+ * @brief This variable stores the number of bytes currently used by the cache.
+ */
+static size_t gnunet_search_result_cache_used;
+/**
+ * @brief This variable stores the maximal number of bytes used by the cache.
+ */
+static unsigned long long gnunet_search_result_cache_capacity;
+/**
+ * @brief This variable stores the lifetime of a cached URL set.
+ */
+static struct GNUNET_TIME_Relative gnunet_search_result_cache_lifetime;
+
+/**
+ * @brief This function returns the number of bytes accounted for an entry.
+ *
+ * @param entry the entry
+ *
+ * @return the number of bytes
+ */
+static size_t gnunet_search_result_cache_entry_footprint(struct gnunet_search_result_cache_entry const *entry) {
+	return sizeof(struct gnunet_search_result_cache_entry) + entry->data_size;
+}
+
+/**
+ * @brief This function removes an entry from the cache and frees it.
+ *
+ * @param entry the entry to remove
+ */
+static void gnunet_search_result_cache_entry_remove(struct gnunet_search_result_cache_entry *entry) {
+	GNUNET_CONTAINER_multihashmap_remove(gnunet_search_result_cache_map, &entry->query, entry);
+	GNUNET_CONTAINER_DLL_remove(gnunet_search_result_cache_head, gnunet_search_result_cache_tail, entry);
+	gnunet_search_result_cache_used -= gnunet_search_result_cache_entry_footprint(entry);
+	GNUNET_free(entry->data);
+	GNUNET_free(entry);
+}
+
+/**
+ * @brief This function evicts the least recently used entries until the cache fits into its memory bound.
+ */
+static void gnunet_search_result_cache_shrink() {
+	while(gnunet_search_result_cache_used > gnunet_search_result_cache_capacity && gnunet_search_result_cache_tail) {
+		gnunet_search_result_cache_entry_remove(gnunet_search_result_cache_tail);
+		GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# result cache evictions"), 1,
+				GNUNET_NO);
+	}
+	GNUNET_STATISTICS_set(gnunet_search_globals_statistics, gettext_noop("# result cache bytes"),
+			gnunet_search_result_cache_used, GNUNET_NO);
+}
+
+/**
+ * @brief This function tests whether an URL is contained in a list of URLs.
+ *
+ * @param data the list of URLs; every URL is terminated by a zero byte
+ * @param data_size the size of the list
+ * @param url the URL to look for
+ *
+ * @return a boolean value indicating whether the URL is contained in the list (1) or not (0)
+ */
+static char gnunet_search_result_cache_url_contains(char const *data, size_t data_size, char const *url) {
+	for(size_t offset = 0; offset < data_size; offset += strlen(data + offset) + 1)
+		if(!strcmp(data + offset, url))
+			return 1;
+	return 0;
+}
+
+/**
+ * @brief This function initialises the result cache component.
+ */
+void gnunet_search_result_cache_init() {
+	gnunet_search_result_cache_capacity = gnunet_search_globals_config_number_get("RESULT_CACHE_SIZE",
+			GNUNET_SEARCH_RESULT_CACHE_SIZE_DEFAULT);
+	gnunet_search_result_cache_lifetime = gnunet_search_globals_config_time_get("RESULT_CACHE_LIFETIME",
+			GNUNET_SEARCH_RESULT_CACHE_LIFETIME_DEFAULT);
+
+	gnunet_search_result_cache_map = GNUNET_CONTAINER_multihashmap_create(64);
+	gnunet_search_result_cache_head = NULL;
+	gnunet_search_result_cache_tail = NULL;
+	gnunet_search_result_cache_used = 0;
+}
+
+/**
+ * @brief This function frees all resources held by the result cache component.
+ */
+void gnunet_search_result_cache_free() {
+	while(gnunet_search_result_cache_head)
+		gnunet_search_result_cache_entry_remove(gnunet_search_result_cache_head);
+	GNUNET_CONTAINER_multihashmap_destroy(gnunet_search_result_cache_map);
+}
+
+/**
+ * @brief This function adds the URLs of a response to the cache.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function adds the URLs of a response to the cache. In case the cache already contains URLs for the request the URLs not yet known are
+ * appended as long as the resulting set still fits into a single response. The entry keeps the expiration it has been created with; merging
+ * URLs does not renew it, so the cached URLs are refreshed from the network at least once per lifetime. An expired entry is replaced. Since
+ * the data is received from the network it is ignored in case it is not terminated by a zero byte.
+ *
+ * @param query the hash of the request the response answers
+ * @param data the URLs; every URL is terminated by a zero byte
+ * @param data_size the size of the URL data
+ */
+void gnunet_search_result_cache_add(GNUNET_HashCode const *query, void const *data, size_t data_size) {
+	char const *urls = (char const*) data;
+	if(!data_size || urls[data_size - 1] || data_size > GNUNET_SEARCH_FLOODING_MESSAGE_MAXIMAL_PAYLOAD_SIZE)
+		return;
+
+	struct gnunet_search_result_cache_entry *entry =
+			(struct gnunet_search_result_cache_entry*) GNUNET_CONTAINER_multihashmap_get(gnunet_search_result_cache_map,
+					query);
+	if(entry && GNUNET_TIME_absolute_get_remaining(entry->expiration).rel_value == 0) {
+		gnunet_search_result_cache_entry_remove(entry);
+		entry = NULL;
+	}
+	if(!entry) {
+		entry = (struct gnunet_search_result_cache_entry*) GNUNET_malloc(sizeof(struct gnunet_search_result_cache_entry));
+		memcpy(&entry->query, query, sizeof(GNUNET_HashCode));
+		entry->data = (char*) GNUNET_malloc(data_size);
+		memcpy(entry->data, data, data_size);
+		entry->data_size = data_size;
+		entry->expiration = GNUNET_TIME_relative_to_absolute(gnunet_search_result_cache_lifetime);
+		GNUNET_CONTAINER_multihashmap_put(gnunet_search_result_cache_map, query, entry,
+				GNUNET_CONTAINER_MULTIHASHMAPOPTION_UNIQUE_ONLY);
+		gnunet_search_result_cache_used += gnunet_search_result_cache_entry_footprint(entry);
+	} else {
+		GNUNET_CONTAINER_DLL_remove(gnunet_search_result_cache_head, gnunet_search_result_cache_tail, entry);
+		for(size_t offset = 0; offset < data_size;) {
+			char const *url = urls + offset;
+			size_t url_size = strlen(url) + 1;
+			offset += url_size;
+
+			if(gnunet_search_result_cache_url_contains(entry->data, entry->data_size, url))
+				continue;
+			if(entry->data_size + url_size > GNUNET_SEARCH_FLOODING_MESSAGE_MAXIMAL_PAYLOAD_SIZE)
+				break;
+
+			entry->data = (char*) GNUNET_realloc(entry->data, entry->data_size + url_size);
+			memcpy(entry->data + entry->data_size, url, url_size);
+			entry->data_size += url_size;
+			gnunet_search_result_cache_used += url_size;
+		}
+	}
+	GNUNET_CONTAINER_DLL_insert(gnunet_search_result_cache_head, gnunet_search_result_cache_tail, entry);
+
+	gnunet_search_result_cache_shrink();
+}
+
+/**
+ * @brief This function looks up the URLs cached for a request.
+ *
+ * @param query the hash of the request
+ * @param data a reference to a variable the function stores a copy of the URLs in; the caller has to free the copy.
+ *
+ * @return the size of the URL data or 0 in case no (valid) entry exists for the request
+ */
+size_t gnunet_search_result_cache_get(GNUNET_HashCode const *query, void **data) {
+	struct gnunet_search_result_cache_entry *entry =
+			(struct gnunet_search_result_cache_entry*) GNUNET_CONTAINER_multihashmap_get(gnunet_search_result_cache_map,
+					query);
+	if(!entry)
+		return 0;
+	if(GNUNET_TIME_absolute_get_remaining(entry->expiration).rel_value == 0) {
+		gnunet_search_result_cache_entry_remove(entry);
+		return 0;
+	}
+
+	GNUNET_CONTAINER_DLL_remove(gnunet_search_result_cache_head, gnunet_search_result_cache_tail, entry);
+	GNUNET_CONTAINER_DLL_insert(gnunet_search_result_cache_head, gnunet_search_result_cache_tail, entry);
+
+	*data = GNUNET_malloc(entry->data_size);
+	memcpy(*data, entry->data, entry->data_size);
+	return entry->data_size;
+}
@@ -0,0 +1,37 @@
+/**
+ * @file search/service/result-cache/result-cache.h
+ * @author Julian Kranz
+ * @date 18.10.2026
+ *
+ * @brief This file defines all exported data structures, functions, constants and variables pertaining to
+ * the GNUnet Search service's result cache component.
+ */
+/*
+ *  This file is part of GNUnet Search.
+ *
+ *  GNUnet Search is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  GNUnet Search is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNUnet Search.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RESULT_CACHE_H_
+#define RESULT_CACHE_H_
+
+#include <gnunet/platform.h>
+#include <gnunet/gnunet_util_lib.h>
+
+extern void gnunet_search_result_cache_init();
+extern void gnunet_search_result_cache_free();
+extern void gnunet_search_result_cache_add(GNUNET_HashCode const *query, void const *data, size_t data_size);
+extern size_t gnunet_search_result_cache_get(GNUNET_HashCode const *query, void **data);
+
+#endif /* RESULT_CACHE_H_ */
@@ -0,0 +1,302 @@
+/**
+ * @file search/service/routing-table/routing-table.c
+ * @author Julian Kranz
+ * @date 18.10.2026
+ *
+ * @brief This file contains all functions pertaining to the GNUnet Search service's routing table component.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This file contains all functions pertaining to the GNUnet Search service's routing table component. This component stores the routing entries
+ * of all flows passing the local peer. It is implemented as an open addressing hash table keyed by the flow id using linear probing; entries
+ * expire after a configurable lifetime instead of being overwritten by newer flows.
+ */
+/*
+ *  This file is part of GNUnet Search.
+ *
+ *  GNUnet Search is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  GNUnet Search is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNUnet Search.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <gnunet/platform.h>
+#include <gnunet/gnunet_util_lib.h>
+
+#include "../globals/globals.h"
+#include "routing-table.h"
+
+/**
+ * @brief This constant defines the default maximal number of flows the routing table keeps track of at the same time.
+ */
+#define GNUNET_SEARCH_ROUTING_TABLE_CAPACITY_DEFAULT 4096
+/**
+ * @brief This constant defines the default lifetime of a routing entry.
+ */
+#define GNUNET_SEARCH_ROUTING_TABLE_ENTRY_LIFETIME_DEFAULT GNUNET_TIME_relative_multiply(GNUNET_TIME_UNIT_MINUTES, 2)
+
+/**
+ * @brief This constant defines the state of a slot that has never been used; a lookup stops probing at such a slot.
+ */
+#define GNUNET_SEARCH_ROUTING_TABLE_SLOT_EMPTY 0
+/**
+ * @brief This constant defines the state of a slot containing an entry; an expired entry may be overwritten by a new one.
+ */
+#define GNUNET_SEARCH_ROUTING_TABLE_SLOT_USED 1
+
+/**
+ * @brief This variable stores a reference to the slots of the routing table.
+ */
+static struct gnunet_search_routing_table_entry *gnunet_search_routing_table_slots;
+/**
+ * @brief This variable stores the number of slots; it is a power of two of at least twice the capacity in order to keep probe sequences short.
+ */
+static size_t gnunet_search_routing_table_slots_length;
+/**
+ * @brief This variable stores the maximal number of entries of the routing table.
+ */
+static size_t gnunet_search_routing_table_capacity;
+/**
+ * @brief This variable stores the number of slots in the used state (including expired entries not purged yet).
+ */
+static size_t gnunet_search_routing_table_used;
+/**
+ * @brief This variable stores the lifetime of a routing entry.
+ */
+static struct GNUNET_TIME_Relative gnunet_search_routing_table_entry_lifetime;
+/**
+ * @brief This variable stores the earliest expiration of all entries in the table; purging earlier is pointless.
+ */
+static struct GNUNET_TIME_Absolute gnunet_search_routing_table_next_purge;
+
+/**
+ * @brief This function computes the home slot of a flow id.
+ *
+ * @param flow_id the flow id
+ *
+ * @return the index of the first slot to probe
+ */
+static size_t gnunet_search_routing_table_slot_home(uint64_t flow_id) {
+	return (size_t) ((flow_id * 0x9E3779B97F4A7C15ULL) >> 32) & (gnunet_search_routing_table_slots_length - 1);
+}
+
+/**
+ * @brief This function tests whether a slot contains a valid (used and not expired) entry.
+ *
+ * @param slot the slot to test
+ * @param now the current time
+ *
+ * @return a boolean value indicating whether the entry is valid (1) or not (0)
+ */
+static char gnunet_search_routing_table_slot_valid(struct gnunet_search_routing_table_entry const *slot,
+		struct GNUNET_TIME_Absolute now) {
+	return slot->state == GNUNET_SEARCH_ROUTING_TABLE_SLOT_USED && slot->expiration.abs_value > now.abs_value;
+}
+
+/**
+ * @brief This function records the statistics of a flow whose entry leaves the routing table and releases the results recorded for the flow.
+ *
+ * @param entry the entry of the flow
+ */
+static void gnunet_search_routing_table_entry_release(struct gnunet_search_routing_table_entry *entry) {
+	if(entry->results_forwarded) {
+		GNUNET_CONTAINER_multihashmap_destroy(entry->results_forwarded);
+		entry->results_forwarded = NULL;
+	}
+
+	GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# flows finished"), 1, GNUNET_NO);
+	GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# flow responses dropped"),
+			entry->responses_dropped, GNUNET_NO);
+	if(entry->requester == GNUNET_SEARCH_ROUTING_TABLE_REQUESTER_LOCAL && !entry->results)
+		GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# local flows finished without results"),
+				1, GNUNET_NO);
+}
+
+/**
+ * @brief This function removes all expired entries by rebuilding the table.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function removes all expired entries by rebuilding the table. All references to entries obtained before become invalid. The function
+ * also records the earliest expiration of the remaining entries; until then another purge cannot free any slot.
+ */
+static void gnunet_search_routing_table_purge() {
+	struct gnunet_search_routing_table_entry *old_slots = gnunet_search_routing_table_slots;
+	struct GNUNET_TIME_Absolute now = GNUNET_TIME_absolute_get();
+
+	gnunet_search_routing_table_slots = (struct gnunet_search_routing_table_entry*) GNUNET_malloc(
+			sizeof(struct gnunet_search_routing_table_entry) * gnunet_search_routing_table_slots_length);
+	memset(gnunet_search_routing_table_slots, 0,
+			sizeof(struct gnunet_search_routing_table_entry) * gnunet_search_routing_table_slots_length);
+	gnunet_search_routing_table_used = 0;
+	gnunet_search_routing_table_next_purge = GNUNET_TIME_absolute_get_forever_();
+
+	for(size_t i = 0; i < gnunet_search_routing_table_slots_length; ++i) {
+		if(!gnunet_search_routing_table_slot_valid(&old_slots[i], now)) {
+			if(old_slots[i].state == GNUNET_SEARCH_ROUTING_TABLE_SLOT_USED)
+				gnunet_search_routing_table_entry_release(&old_slots[i]);
+			continue;
+		}
+		size_t index = gnunet_search_routing_table_slot_home(old_slots[i].flow_id);
+		while(gnunet_search_routing_table_slots[index].state != GNUNET_SEARCH_ROUTING_TABLE_SLOT_EMPTY)
+			index = (index + 1) & (gnunet_search_routing_table_slots_length - 1);
+		memcpy(&gnunet_search_routing_table_slots[index], &old_slots[i],
+				sizeof(struct gnunet_search_routing_table_entry));
+		gnunet_search_routing_table_used++;
+		gnunet_search_routing_table_next_purge = GNUNET_TIME_absolute_min(gnunet_search_routing_table_next_purge,
+				old_slots[i].expiration);
+	}
+
+	GNUNET_free(old_slots);
+
+	GNUNET_STATISTICS_set(gnunet_search_globals_statistics, gettext_noop("# routing table entries"),
+			gnunet_search_routing_table_used, GNUNET_NO);
+}
+
+/**
+ * @brief This function initialises the routing table component.
+ */
+void gnunet_search_routing_table_init() {
+	gnunet_search_routing_table_capacity = GNUNET_MAX(1,
+			gnunet_search_globals_config_number_get("ROUTING_TABLE_SIZE", GNUNET_SEARCH_ROUTING_TABLE_CAPACITY_DEFAULT));
+	gnunet_search_routing_table_entry_lifetime = gnunet_search_globals_config_time_get("ROUTING_ENTRY_LIFETIME",
+			GNUNET_SEARCH_ROUTING_TABLE_ENTRY_LIFETIME_DEFAULT);
+
+	gnunet_search_routing_table_slots_length = 1;
+	while(gnunet_search_routing_table_slots_length < 2 * gnunet_search_routing_table_capacity)
+		gnunet_search_routing_table_slots_length <<= 1;
+
+	gnunet_search_routing_table_slots = (struct gnunet_search_routing_table_entry*) GNUNET_malloc(
+			sizeof(struct gnunet_search_routing_table_entry) * gnunet_search_routing_table_slots_length);
+	memset(gnunet_search_routing_table_slots, 0,
+			sizeof(struct gnunet_search_routing_table_entry) * gnunet_search_routing_table_slots_length);
+	gnunet_search_routing_table_used = 0;
+	gnunet_search_routing_table_next_purge = GNUNET_TIME_absolute_get_forever_();
+}
+
+/**
+ * @brief This function releases all resources held by the routing table component.
+ */
+void gnunet_search_routing_table_free() {
+	for(size_t i = 0; i < gnunet_search_routing_table_slots_length; ++i)
+		if(gnunet_search_routing_table_slots[i].results_forwarded)
+			GNUNET_CONTAINER_multihashmap_destroy(gnunet_search_routing_table_slots[i].results_forwarded);
+	GNUNET_free(gnunet_search_routing_table_slots);
+}
+
+/**
+ * @brief This function looks up the routing entry of a flow.
+ *
+ * @param flow_id the flow id to search for
+ *
+ * @return a reference to the entry or NULL in case the flow is unknown or its entry has expired; the reference is only valid until the next
+ * entry is added.
+ */
+struct gnunet_search_routing_table_entry *gnunet_search_routing_table_get(uint64_t flow_id) {
+	struct GNUNET_TIME_Absolute now = GNUNET_TIME_absolute_get();
+	size_t index = gnunet_search_routing_table_slot_home(flow_id);
+	for(size_t probes = 0; probes < gnunet_search_routing_table_slots_length; ++probes) {
+		struct gnunet_search_routing_table_entry *slot = &gnunet_search_routing_table_slots[index];
+		if(slot->state == GNUNET_SEARCH_ROUTING_TABLE_SLOT_EMPTY)
+			break;
+		if(slot->state == GNUNET_SEARCH_ROUTING_TABLE_SLOT_USED && slot->flow_id == flow_id)
+			return gnunet_search_routing_table_slot_valid(slot, now) ? slot : NULL;
+		index = (index + 1) & (gnunet_search_routing_table_slots_length - 1);
+	}
+	return NULL;
+}
+
+/**
+ * @brief This function adds a new routing entry for a flow.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function adds a new routing entry for a flow. The entry expires after the configured lifetime. An expired entry found while probing
+ * for a free slot is overwritten. In case the table has reached its capacity expired entries are purged first; the table is only rebuilt once
+ * the earliest entry has expired, so a full table of valid entries does not cause a rebuild per request. If the table is still full no entry
+ * is added. The caller has to make sure that the flow is
+ * not already contained in the table (see gnunet_search_routing_table_get()) and has to fill in the requester and the next hop.
+ *
+ * @param flow_id the flow id of the new entry
+ *
+ * @return a reference to the new entry or NULL in case the table is full; the reference is only valid until the next entry is added.
+ */
+struct gnunet_search_routing_table_entry *gnunet_search_routing_table_add(uint64_t flow_id) {
+	struct GNUNET_TIME_Absolute now = GNUNET_TIME_absolute_get();
+
+	if(gnunet_search_routing_table_used >= gnunet_search_routing_table_capacity
+			&& now.abs_value >= gnunet_search_routing_table_next_purge.abs_value)
+		gnunet_search_routing_table_purge();
+
+	if(gnunet_search_routing_table_used >= gnunet_search_routing_table_capacity) {
+		GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# routing table full"), 1,
+				GNUNET_NO);
+		return NULL;
+	}
+
+	size_t index = gnunet_search_routing_table_slot_home(flow_id);
+	while(gnunet_search_routing_table_slot_valid(&gnunet_search_routing_table_slots[index], now))
+		index = (index + 1) & (gnunet_search_routing_table_slots_length - 1);
+
+	struct gnunet_search_routing_table_entry *slot = &gnunet_search_routing_table_slots[index];
+	if(slot->state == GNUNET_SEARCH_ROUTING_TABLE_SLOT_USED)
+		gnunet_search_routing_table_entry_release(slot);
+	else
+		gnunet_search_routing_table_used++;
+
+	memset(slot, 0, sizeof(struct gnunet_search_routing_table_entry));
+	slot->flow_id = flow_id;
+	slot->created = now;
+	slot->expiration = GNUNET_TIME_absolute_add(now, gnunet_search_routing_table_entry_lifetime);
+	slot->state = GNUNET_SEARCH_ROUTING_TABLE_SLOT_USED;
+	gnunet_search_routing_table_next_purge = GNUNET_TIME_absolute_min(gnunet_search_routing_table_next_purge,
+			slot->expiration);
+
+	return slot;
+}
+
+/**
+ * @brief This function tests whether a result has already been forwarded for a flow.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function tests whether a result has already been forwarded for a flow. The hashes of the results forwarded are stored in a hash map
+ * belonging to the routing entry; the test is thus exact (up to hash collisions) independent of the number of results of the flow.
+ *
+ * @param entry the routing entry of the flow
+ * @param hash the hash of the result
+ *
+ * @return a boolean value indicating whether the result has been forwarded before (1) or not (0)
+ */
+uint8_t gnunet_search_routing_table_entry_result_test(struct gnunet_search_routing_table_entry const *entry,
+		GNUNET_HashCode const *hash) {
+	return entry->results_forwarded
+			&& GNUNET_CONTAINER_multihashmap_contains(entry->results_forwarded, hash) == GNUNET_YES;
+}
+
+/**
+ * @brief This function marks a result as forwarded for a flow (see above); the hash map is created with the first result.
+ *
+ * @param entry the routing entry of the flow
+ * @param hash the hash of the result
+ */
+void gnunet_search_routing_table_entry_result_set(struct gnunet_search_routing_table_entry *entry,
+		GNUNET_HashCode const *hash) {
+	if(!entry->results_forwarded)
+		entry->results_forwarded = GNUNET_CONTAINER_multihashmap_create(16);
+	GNUNET_CONTAINER_multihashmap_put(entry->results_forwarded, hash, NULL,
+			GNUNET_CONTAINER_MULTIHASHMAPOPTION_UNIQUE_ONLY);
+}
@@ -0,0 +1,139 @@
+/**
+ * @file search/service/routing-table/routing-table.h
+ * @author Julian Kranz
+ * @date 18.10.2026
+ *
+ * @brief This file defines all exported data structures, functions, constants and variables pertaining to
+ * the GNUnet Search service's routing table component.
+ */
+/*
+ *  This file is part of GNUnet Search.
+ *
+ *  GNUnet Search is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  GNUnet Search is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNUnet Search.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef ROUTING_TABLE_H_
+#define ROUTING_TABLE_H_
+
+#include <stdint.h>
+
+#include <gnunet/platform.h>
+#include <gnunet/gnunet_util_lib.h>
+
+/**
+ * @brief This enumeration defines the kinds of requesters a flow may have been started by.
+ */
+enum gnunet_search_routing_table_requester {
+	/**
+	 * @brief The request of the flow has been received from a neighbour; responses are forwarded to that neighbour.
+	 */
+	GNUNET_SEARCH_ROUTING_TABLE_REQUESTER_NEIGHBOUR,
+	/**
+	 * @brief The request of the flow originated locally; responses are handed to the local notification handler.
+	 */
+	GNUNET_SEARCH_ROUTING_TABLE_REQUESTER_LOCAL
+};
+
+/**
+ * @brief This data structure represents an entry in the routing table.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This data structure represents an entry in the routing table. The routing table is used to be able to forward response messages back
+ * to their originator. Whenever a request passes a node it remembers the sending node and the flow id. Since the response will carry
+ * the same flow id the node is able to look up the next hop using the flow id of the response message.
+ */
+struct gnunet_search_routing_table_entry {
+	/**
+	 * @brief This member stores the flow (one request, possibly multiple responses) id associated with the message flow the routing entry is used for.
+	 */
+	uint64_t flow_id;
+	/**
+	 * @brief This member stores the next hop to forward response messages to.
+	 */
+	struct GNUNET_PeerIdentity next_hop;
+	/**
+	 * @brief This member stores the kind of requester that started the flow (see above). In case the request originated locally the data stored
+	 * in the next_hop attribute is invalid.
+	 */
+	uint8_t requester;
+	/**
+	 * @brief This member stores the time the flow has been started at this peer.
+	 */
+	struct GNUNET_TIME_Absolute created;
+	/**
+	 * @brief This member stores the highest TTL a request of the flow has been received with; a request received again with a higher TTL
+	 * (expanding ring search) is forwarded again.
+	 */
+	uint8_t ttl;
+	/**
+	 * @brief This member stores the hash of the normalized keyword of the request of the flow; it is used as key for caching the responses of
+	 * the flow.
+	 */
+	GNUNET_HashCode query;
+	/**
+	 * @brief This member stores the time the request of the flow has been forwarded last; it is used to measure the latency of the responses.
+	 */
+	struct GNUNET_TIME_Absolute forwarded;
+	/**
+	 * @brief This member stores a bit set of the neighbours that have responded to the flow; a neighbour is mapped to a bit using the hash of its
+	 * identity. It is used to measure the latency of the first response of every neighbour.
+	 */
+	uint64_t responders;
+	/**
+	 * @brief This member stores the number of responses received for the flow.
+	 */
+	uint32_t responses;
+	/**
+	 * @brief This member stores the number of responses received for the flow that have been dropped (empty, duplicate or beyond the result limit).
+	 */
+	uint32_t responses_dropped;
+	/**
+	 * @brief This member stores a boolean value indicating whether the flow has been cancelled by its requester (1) or not (0). The entry of a
+	 * cancelled flow is kept until it expires in order to discard requests and responses of the flow still in transit.
+	 */
+	uint8_t cancelled;
+	/**
+	 * @brief This member stores the maximal number of distinct results forwarded for the flow; 0 means no limit.
+	 */
+	uint16_t max_results;
+	/**
+	 * @brief This member stores the number of distinct results forwarded for the flow.
+	 */
+	uint32_t results;
+	/**
+	 * @brief This member stores the hashes of the results already forwarded for the flow; it is used to suppress duplicate results. It is NULL
+	 * as long as no result has been forwarded.
+	 */
+	struct GNUNET_CONTAINER_MultiHashMap *results_forwarded;
+	/**
+	 * @brief This member stores the time the entry expires; an expired entry is treated as if it was not contained in the table.
+	 */
+	struct GNUNET_TIME_Absolute expiration;
+	/**
+	 * @brief This member stores the state of the slot (see the routing table component).
+	 */
+	uint8_t state;
+};
+
+extern void gnunet_search_routing_table_init();
+extern void gnunet_search_routing_table_free();
+extern struct gnunet_search_routing_table_entry *gnunet_search_routing_table_get(uint64_t flow_id);
+extern struct gnunet_search_routing_table_entry *gnunet_search_routing_table_add(uint64_t flow_id);
+extern uint8_t gnunet_search_routing_table_entry_result_test(struct gnunet_search_routing_table_entry const *entry,
+		GNUNET_HashCode const *hash);
+extern void gnunet_search_routing_table_entry_result_set(struct gnunet_search_routing_table_entry *entry,
+		GNUNET_HashCode const *hash);
+
+#endif /* ROUTING_TABLE_H_ */
@@ -37,6 +37,7 @@
 
 #include "storage.h"
 #include "../globals/globals.h"
+#include "../summary/summary.h"
 
 /**
  * @brief This variable stores a reference to a dictionary containing the locally stored data.
@@ -113,7 +114,8 @@ void gnunet_search_storage_free() {
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
  * This function adds a new key value combination to the storage. For this purpose it first checks whether the key is already contained in the dictionary implementing the
- * storage. If it is not a new dynamic array is created containing only the new value and the data is added to the dictionary. If the key is already contained its corresponding
+ * storage. If it is not a new dynamic array is created containing only the new value and the data is added to the dictionary; the new key is also added to the
+ * keyword summary of the local peer (see the summary component). If the key is already contained its corresponding
  * value array is searched for the value to insert. If the value is not yet contained in the dynamic array belonging to the key it is inserted.
  *
  * @param key the key to add (the normalized search keyword)
@@ -140,6 +142,7 @@ void gnunet_search_storage_key_value_add(char const *key, char const *value) {
 		array_list_insert(known_values, value_copy);
 
 		al_dictionary_insert(storage, key_copy, known_values);
+		gnunet_search_summary_keyword_add(key);
 	} else {
 		known_values = (array_list_t *) from_storage;
 
@@ -0,0 +1,409 @@
+/**
+ * @file search/service/summary/summary.c
+ * @author Julian Kranz
+ * @date 18.10.2026
+ *
+ * @brief This file contains all functions pertaining to the GNUnet Search service's summary component.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This file contains all functions pertaining to the GNUnet Search service's summary component. This component maintains compact summaries of
+ * the keywords stored in the neighbourhood of the local peer; these summaries are used by the flooding component to forward a request only to
+ * those neighbours that may lead to a peer knowing the keyword. A summary is an attenuated Bloom filter: level 0 of the filter a peer sends to a
+ * neighbour contains its own keywords, level i contains the keywords the other neighbours reported on level i - 1. The summaries are exchanged
+ * when two peers connect; afterwards only the bytes that changed are sent periodically.
+ */
+/*
+ *  This file is part of GNUnet Search.
+ *
+ *  GNUnet Search is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  GNUnet Search is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNUnet Search.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#define _GNU_SOURCE
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <gnunet/platform.h>
+#include <gnunet/gnunet_util_lib.h>
+
+#include "../globals/globals.h"
+#include "../flooding/flooding.h"
+#include "summary.h"
+
+/**
+ * @brief This constant defines the default interval (in seconds) after which changed summaries are sent to the neighbours.
+ */
+#define GNUNET_SEARCH_SUMMARY_INTERVAL_DEFAULT 30
+/**
+ * @brief This constant defines the default number of intervals after which a full summary is sent instead of a delta.
+ */
+#define GNUNET_SEARCH_SUMMARY_REFRESH_ROUNDS_DEFAULT 10
+
+/**
+ * @brief This constant defines the size of all levels of an attenuated Bloom filter in bytes.
+ */
+#define GNUNET_SEARCH_SUMMARY_SIZE (GNUNET_SEARCH_SUMMARY_LEVELS * GNUNET_SEARCH_SUMMARY_FILTER_SIZE)
+
+/**
+ * @brief This data structure stores the summaries exchanged with a neighbour.
+ */
+struct gnunet_search_summary_neighbour {
+	/**
+	 * @brief This member stores a reference to the previous element of the list of neighbours.
+	 */
+	struct gnunet_search_summary_neighbour *prev;
+	/**
+	 * @brief This member stores a reference to the next element of the list of neighbours.
+	 */
+	struct gnunet_search_summary_neighbour *next;
+	/**
+	 * @brief This member stores the identity of the neighbour.
+	 */
+	struct GNUNET_PeerIdentity identity;
+	/**
+	 * @brief This member stores a boolean value indicating whether a full summary has been received from the neighbour.
+	 */
+	uint8_t received_valid;
+	/**
+	 * @brief This member stores the summary received from the neighbour.
+	 */
+	uint8_t received[GNUNET_SEARCH_SUMMARY_SIZE];
+	/**
+	 * @brief This member stores the summary sent to the neighbour last; deltas are computed relative to it.
+	 */
+	uint8_t sent[GNUNET_SEARCH_SUMMARY_SIZE];
+	/**
+	 * @brief This member stores the number of intervals since the last full summary has been sent to the neighbour.
+	 */
+	unsigned int rounds;
+};
+
+/**
+ * @brief This variable stores the Bloom filter of the keywords stored locally.
+ */
+static uint8_t gnunet_search_summary_local[GNUNET_SEARCH_SUMMARY_FILTER_SIZE];
+/**
+ * @brief This variable stores a reference to the map from peer identities to neighbours.
+ */
+static struct GNUNET_CONTAINER_MultiHashMap *gnunet_search_summary_neighbours;
+/**
+ * @brief This variable stores a reference to the first element of the list of neighbours.
+ */
+static struct gnunet_search_summary_neighbour *gnunet_search_summary_neighbours_head;
+/**
+ * @brief This variable stores a reference to the last element of the list of neighbours.
+ */
+static struct gnunet_search_summary_neighbour *gnunet_search_summary_neighbours_tail;
+/**
+ * @brief This variable stores the interval after which changed summaries are sent to the neighbours.
+ */
+static struct GNUNET_TIME_Relative gnunet_search_summary_interval;
+/**
+ * @brief This variable stores the number of intervals after which a full summary is sent instead of a delta.
+ */
+static unsigned long long gnunet_search_summary_refresh_rounds;
+/**
+ * @brief This variable stores the task sending the changed summaries.
+ */
+static GNUNET_SCHEDULER_TaskIdentifier gnunet_search_summary_task;
+
+/**
+ * @brief This function computes the summary to be sent to a neighbour.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function computes the summary to be sent to a neighbour. Level 0 is the filter of the keywords stored locally; level i is the union of the
+ * levels i - 1 received from all other neighbours. The summary received from the neighbour itself is excluded; otherwise the neighbour would find
+ * its own keywords behind the local peer.
+ *
+ * @param neighbour the neighbour
+ * @param summary the buffer to store the summary in
+ */
+static void gnunet_search_summary_advertised_get(struct gnunet_search_summary_neighbour const *neighbour, uint8_t *summary) {
+	memcpy(summary, gnunet_search_summary_local, GNUNET_SEARCH_SUMMARY_FILTER_SIZE);
+	memset(summary + GNUNET_SEARCH_SUMMARY_FILTER_SIZE, 0, GNUNET_SEARCH_SUMMARY_SIZE - GNUNET_SEARCH_SUMMARY_FILTER_SIZE);
+	for(struct gnunet_search_summary_neighbour *other = gnunet_search_summary_neighbours_head; other; other = other->next) {
+		if(other == neighbour || !other->received_valid)
+			continue;
+		for(size_t i = GNUNET_SEARCH_SUMMARY_FILTER_SIZE; i < GNUNET_SEARCH_SUMMARY_SIZE; ++i)
+			summary[i] |= other->received[i - GNUNET_SEARCH_SUMMARY_FILTER_SIZE];
+	}
+}
+
+/**
+ * @brief This function sends the full summary to a neighbour.
+ *
+ * @param neighbour the neighbour
+ * @param summary the summary to send
+ */
+static void gnunet_search_summary_full_send(struct gnunet_search_summary_neighbour *neighbour, uint8_t const *summary) {
+	size_t message_size = sizeof(struct gnunet_search_summary_message) + GNUNET_SEARCH_SUMMARY_SIZE;
+	struct gnunet_search_summary_message *message = (struct gnunet_search_summary_message*) GNUNET_malloc(message_size);
+	message->full = 1;
+	message->changes = 0;
+	memcpy(message + 1, summary, GNUNET_SEARCH_SUMMARY_SIZE);
+
+	gnunet_search_flooding_peer_summary_send(&neighbour->identity, message, message_size);
+	GNUNET_free(message);
+
+	memcpy(neighbour->sent, summary, GNUNET_SEARCH_SUMMARY_SIZE);
+	neighbour->rounds = 0;
+	GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# summaries sent"), 1, GNUNET_NO);
+}
+
+/**
+ * @brief This function sends the changes of the summary to a neighbour.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function sends the changes of the summary to a neighbour. Every changed byte is sent together with its offset; in case the changes would be
+ * larger than the full summary (or a full summary is due, see above) the full summary is sent instead. Nothing is sent in case the summary did not change.
+ *
+ * @param neighbour the neighbour
+ * @param summary the summary to send
+ */
+static void gnunet_search_summary_delta_send(struct gnunet_search_summary_neighbour *neighbour, uint8_t const *summary) {
+	size_t changes = 0;
+	for(size_t i = 0; i < GNUNET_SEARCH_SUMMARY_SIZE; ++i)
+		if(summary[i] != neighbour->sent[i])
+			changes++;
+	neighbour->rounds++;
+	if(neighbour->rounds >= gnunet_search_summary_refresh_rounds
+			|| changes * sizeof(struct gnunet_search_summary_change) >= GNUNET_SEARCH_SUMMARY_SIZE) {
+		gnunet_search_summary_full_send(neighbour, summary);
+		return;
+	}
+	if(!changes)
+		return;
+
+	size_t message_size = sizeof(struct gnunet_search_summary_message) + changes * sizeof(struct gnunet_search_summary_change);
+	struct gnunet_search_summary_message *message = (struct gnunet_search_summary_message*) GNUNET_malloc(message_size);
+	message->full = 0;
+	message->changes = htons(changes);
+	struct gnunet_search_summary_change *change = (struct gnunet_search_summary_change*) (message + 1);
+	for(size_t i = 0; i < GNUNET_SEARCH_SUMMARY_SIZE; ++i) {
+		if(summary[i] == neighbour->sent[i])
+			continue;
+		change->offset = htons(i);
+		change->value = summary[i];
+		change++;
+	}
+
+	gnunet_search_flooding_peer_summary_send(&neighbour->identity, message, message_size);
+	GNUNET_free(message);
+
+	memcpy(neighbour->sent, summary, GNUNET_SEARCH_SUMMARY_SIZE);
+	GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# summary deltas sent"), 1, GNUNET_NO);
+}
+
+/**
+ * @brief This function sends the changed summaries to all neighbours; it reschedules itself.
+ *
+ * @param cls the GNUnet closure (not used)
+ * @param tc the GNUnet scheduler task context (not used)
+ */
+static void gnunet_search_summary_update(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc) {
+	gnunet_search_summary_task = GNUNET_SCHEDULER_NO_TASK;
+
+	uint8_t *summary = (uint8_t*) GNUNET_malloc(GNUNET_SEARCH_SUMMARY_SIZE);
+	for(struct gnunet_search_summary_neighbour *neighbour = gnunet_search_summary_neighbours_head; neighbour;
+			neighbour = neighbour->next) {
+		gnunet_search_summary_advertised_get(neighbour, summary);
+		gnunet_search_summary_delta_send(neighbour, summary);
+	}
+	GNUNET_free(summary);
+
+	gnunet_search_summary_task = GNUNET_SCHEDULER_add_delayed(gnunet_search_summary_interval,
+			&gnunet_search_summary_update, NULL);
+}
+
+/**
+ * @brief This function tests whether all bits of a keyword are set in a Bloom filter.
+ *
+ * @param filter the filter
+ * @param keyword_hash the hash of the keyword
+ *
+ * @return a boolean value indicating whether the keyword is (probably) contained in the filter (1) or not (0)
+ */
+static uint8_t gnunet_search_summary_filter_test(uint8_t const *filter, GNUNET_HashCode const *keyword_hash) {
+	for(unsigned int i = 0; i < GNUNET_SEARCH_SUMMARY_FILTER_HASHES; ++i) {
+		uint32_t bit = keyword_hash->bits[i] % (GNUNET_SEARCH_SUMMARY_FILTER_SIZE * 8);
+		if(!(filter[bit / 8] & (1 << (bit % 8))))
+			return 0;
+	}
+	return 1;
+}
+
+/**
+ * @brief This function initialises the summary component.
+ */
+void gnunet_search_summary_init() {
+	gnunet_search_summary_interval = gnunet_search_globals_config_time_get("SUMMARY_INTERVAL",
+			GNUNET_TIME_relative_multiply(GNUNET_TIME_UNIT_SECONDS, GNUNET_SEARCH_SUMMARY_INTERVAL_DEFAULT));
+	gnunet_search_summary_refresh_rounds = GNUNET_MAX(1,
+			gnunet_search_globals_config_number_get("SUMMARY_REFRESH_ROUNDS", GNUNET_SEARCH_SUMMARY_REFRESH_ROUNDS_DEFAULT));
+
+	memset(gnunet_search_summary_local, 0, GNUNET_SEARCH_SUMMARY_FILTER_SIZE);
+	gnunet_search_summary_neighbours = GNUNET_CONTAINER_multihashmap_create(16);
+	gnunet_search_summary_neighbours_head = NULL;
+	gnunet_search_summary_neighbours_tail = NULL;
+
+	gnunet_search_summary_task = GNUNET_SCHEDULER_add_delayed(gnunet_search_summary_interval,
+			&gnunet_search_summary_update, NULL);
+}
+
+/**
+ * @brief This function frees all resources held by the summary component.
+ */
+void gnunet_search_summary_free() {
+	if(gnunet_search_summary_task != GNUNET_SCHEDULER_NO_TASK)
+		GNUNET_SCHEDULER_cancel(gnunet_search_summary_task);
+	while(gnunet_search_summary_neighbours_head)
+		gnunet_search_summary_neighbour_disconnect(&gnunet_search_summary_neighbours_head->identity);
+	GNUNET_CONTAINER_multihashmap_destroy(gnunet_search_summary_neighbours);
+}
+
+/**
+ * @brief This function computes the hash of a keyword used for the summaries.
+ *
+ * @param keyword the (normalized) keyword
+ * @param hash a reference to a variable to store the hash in
+ */
+void gnunet_search_summary_keyword_hash(char const *keyword, GNUNET_HashCode *hash) {
+	GNUNET_CRYPTO_hash(keyword, strlen(keyword), hash);
+}
+
+/**
+ * @brief This function adds a keyword stored locally to the summary; the neighbours learn about the keyword with the next delta.
+ *
+ * @param keyword the (normalized) keyword
+ */
+void gnunet_search_summary_keyword_add(char const *keyword) {
+	GNUNET_HashCode hash;
+	gnunet_search_summary_keyword_hash(keyword, &hash);
+	for(unsigned int i = 0; i < GNUNET_SEARCH_SUMMARY_FILTER_HASHES; ++i) {
+		uint32_t bit = hash.bits[i] % (GNUNET_SEARCH_SUMMARY_FILTER_SIZE * 8);
+		gnunet_search_summary_local[bit / 8] |= 1 << (bit % 8);
+	}
+}
+
+/**
+ * @brief This function is called in case a new neighbour connects; it sends the full summary to the neighbour.
+ *
+ * @param peer the neighbour
+ */
+void gnunet_search_summary_neighbour_connect(struct GNUNET_PeerIdentity const *peer) {
+	if(GNUNET_CONTAINER_multihashmap_contains(gnunet_search_summary_neighbours, &peer->hashPubKey))
+		return;
+
+	struct gnunet_search_summary_neighbour *neighbour = (struct gnunet_search_summary_neighbour*) GNUNET_malloc(
+			sizeof(struct gnunet_search_summary_neighbour));
+	memcpy(&neighbour->identity, peer, sizeof(struct GNUNET_PeerIdentity));
+	GNUNET_CONTAINER_multihashmap_put(gnunet_search_summary_neighbours, &peer->hashPubKey, neighbour,
+			GNUNET_CONTAINER_MULTIHASHMAPOPTION_UNIQUE_ONLY);
+	GNUNET_CONTAINER_DLL_insert(gnunet_search_summary_neighbours_head, gnunet_search_summary_neighbours_tail, neighbour);
+
+	uint8_t *summary = (uint8_t*) GNUNET_malloc(GNUNET_SEARCH_SUMMARY_SIZE);
+	gnunet_search_summary_advertised_get(neighbour, summary);
+	gnunet_search_summary_full_send(neighbour, summary);
+	GNUNET_free(summary);
+}
+
+/**
+ * @brief This function is called in case a neighbour disconnects; it forgets the summaries of the neighbour.
+ *
+ * @param peer the neighbour
+ */
+void gnunet_search_summary_neighbour_disconnect(struct GNUNET_PeerIdentity const *peer) {
+	struct gnunet_search_summary_neighbour *neighbour =
+			(struct gnunet_search_summary_neighbour*) GNUNET_CONTAINER_multihashmap_get(gnunet_search_summary_neighbours,
+					&peer->hashPubKey);
+	if(!neighbour)
+		return;
+	GNUNET_CONTAINER_multihashmap_remove(gnunet_search_summary_neighbours, &neighbour->identity.hashPubKey, neighbour);
+	GNUNET_CONTAINER_DLL_remove(gnunet_search_summary_neighbours_head, gnunet_search_summary_neighbours_tail, neighbour);
+	GNUNET_free(neighbour);
+}
+
+/**
+ * @brief This function processes a summary message received from a neighbour.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function processes a summary message received from a neighbour. A full summary replaces the summary stored for the neighbour; a delta is
+ * applied to it. A delta received before any full summary is ignored since the summary it refers to is unknown. Malformed messages are discarded.
+ *
+ * @param sender the neighbour the message has been received from
+ * @param data the summary message
+ * @param data_size the size of the summary message
+ */
+void gnunet_search_summary_message_process(struct GNUNET_PeerIdentity const *sender, void const *data, size_t data_size) {
+	struct gnunet_search_summary_neighbour *neighbour =
+			(struct gnunet_search_summary_neighbour*) GNUNET_CONTAINER_multihashmap_get(gnunet_search_summary_neighbours,
+					&sender->hashPubKey);
+	if(!neighbour || data_size < sizeof(struct gnunet_search_summary_message))
+		return;
+
+	/*
+	 * Security, data from network
+	 */
+	struct gnunet_search_summary_message const *message = (struct gnunet_search_summary_message const*) data;
+	if(message->full) {
+		if(data_size != sizeof(struct gnunet_search_summary_message) + GNUNET_SEARCH_SUMMARY_SIZE)
+			return;
+		memcpy(neighbour->received, message + 1, GNUNET_SEARCH_SUMMARY_SIZE);
+		neighbour->received_valid = 1;
+	} else {
+		size_t changes = ntohs(message->changes);
+		if(!neighbour->received_valid
+				|| data_size != sizeof(struct gnunet_search_summary_message) + changes * sizeof(struct gnunet_search_summary_change))
+			return;
+		struct gnunet_search_summary_change const *change = (struct gnunet_search_summary_change const*) (message + 1);
+		for(size_t i = 0; i < changes; ++i) {
+			uint16_t offset = ntohs(change[i].offset);
+			if(offset < GNUNET_SEARCH_SUMMARY_SIZE)
+				neighbour->received[offset] = change[i].value;
+		}
+	}
+	GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# summaries received"), 1, GNUNET_NO);
+}
+
+/**
+ * @brief This function tests whether a keyword may be found through a neighbour.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function tests whether a keyword may be found through a neighbour within a given number of hops. Only the levels of the neighbour's summary
+ * covering the hops are tested. A neighbour that has not sent a summary yet is assumed to know every keyword.
+ *
+ * @param peer the neighbour
+ * @param keyword_hash the hash of the keyword
+ * @param hops the number of hops (counted from the local peer) a request sent to the neighbour travels
+ *
+ * @return a boolean value indicating whether the keyword may be found through the neighbour (1) or not (0)
+ */
+uint8_t gnunet_search_summary_neighbour_may_contain(struct GNUNET_PeerIdentity const *peer,
+		GNUNET_HashCode const *keyword_hash, unsigned int hops) {
+	struct gnunet_search_summary_neighbour *neighbour =
+			(struct gnunet_search_summary_neighbour*) GNUNET_CONTAINER_multihashmap_get(gnunet_search_summary_neighbours,
+					&peer->hashPubKey);
+	if(!neighbour || !neighbour->received_valid)
+		return 1;
+
+	for(unsigned int level = 0; level < hops && level < GNUNET_SEARCH_SUMMARY_LEVELS; ++level)
+		if(gnunet_search_summary_filter_test(neighbour->received + level * GNUNET_SEARCH_SUMMARY_FILTER_SIZE, keyword_hash))
+			return 1;
+	return 0;
+}
@@ -0,0 +1,91 @@
+/**
+ * @file search/service/summary/summary.h
+ * @author Julian Kranz
+ * @date 18.10.2026
+ *
+ * @brief This file defines all exported data structures, functions, constants and variables pertaining to
+ * the GNUnet Search service's summary component.
+ */
+/*
+ *  This file is part of GNUnet Search.
+ *
+ *  GNUnet Search is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  GNUnet Search is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNUnet Search.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUMMARY_H_
+#define SUMMARY_H_
+
+#include <stdint.h>
+
+#include <gnunet/platform.h>
+#include <gnunet/gnunet_util_lib.h>
+
+/**
+ * @brief This constant defines the number of levels of an attenuated Bloom filter; level i summarises the keywords stored i + 1 hops away.
+ */
+#define GNUNET_SEARCH_SUMMARY_LEVELS 3
+/**
+ * @brief This constant defines the size of a single level of an attenuated Bloom filter in bytes.
+ */
+#define GNUNET_SEARCH_SUMMARY_FILTER_SIZE 4096
+/**
+ * @brief This constant defines the number of bits set in a Bloom filter for each keyword.
+ */
+#define GNUNET_SEARCH_SUMMARY_FILTER_HASHES 4
+
+/**
+ * @brief This data structure defines the header of a summary message exchanged between neighbours.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This data structure defines the header of a summary message exchanged between neighbours. A full summary message is followed by all levels of the
+ * attenuated Bloom filter; a delta summary message is followed by a number of changes (see below) relative to the summary sent before.
+ */
+struct __attribute__((__packed__)) gnunet_search_summary_message {
+	/**
+	 * @brief This member stores a boolean value indicating whether the message contains the full filter (1) or a delta (0).
+	 */
+	uint8_t full;
+	/**
+	 * @brief This member stores the number of changes following a delta message; it is in network byte order.
+	 */
+	uint16_t changes;
+};
+
+/**
+ * @brief This data structure represents a single change of a delta summary message.
+ */
+struct __attribute__((__packed__)) gnunet_search_summary_change {
+	/**
+	 * @brief This member stores the offset of the changed byte within the concatenated levels of the filter; it is in network byte order.
+	 */
+	uint16_t offset;
+	/**
+	 * @brief This member stores the new value of the byte.
+	 */
+	uint8_t value;
+};
+
+extern void gnunet_search_summary_init();
+extern void gnunet_search_summary_free();
+extern void gnunet_search_summary_keyword_hash(char const *keyword, GNUNET_HashCode *hash);
+extern void gnunet_search_summary_keyword_add(char const *keyword);
+extern void gnunet_search_summary_neighbour_connect(struct GNUNET_PeerIdentity const *peer);
+extern void gnunet_search_summary_neighbour_disconnect(struct GNUNET_PeerIdentity const *peer);
+extern void gnunet_search_summary_message_process(struct GNUNET_PeerIdentity const *sender, void const *data,
+		size_t data_size);
+extern uint8_t gnunet_search_summary_neighbour_may_contain(struct GNUNET_PeerIdentity const *peer,
+		GNUNET_HashCode const *keyword_hash, unsigned int hops);
+
+#endif /* SUMMARY_H_ */
@@ -41,62 +41,176 @@
 #include "../storage/storage.h"
 #include "../dht/dht.h"
 #include "../normalization/normalization.h"
+#include "../flooding/flooding.h"
+#include "../globals/globals.h"
 
 /**
- * @brief This function extracts a parameter and an URL from a value (structured by the GNUnet search) received while monitoring the DHT.
+ * @brief This constant defines the default number of peers closest to an URL that crawl the URL.
+ */
+#define GNUNET_SEARCH_URL_PROCESSOR_CRAWL_REDUNDANCY_DEFAULT 2
+/**
+ * @brief This constant defines the default time an URL is remembered as seen.
+ */
+#define GNUNET_SEARCH_URL_PROCESSOR_SEEN_WINDOW_DEFAULT GNUNET_TIME_UNIT_HOURS
+
+/**
+ * @brief This structure describes an URL seen recently.
+ */
+struct gnunet_search_url_processor_seen_entry {
+	/**
+	 * @brief This member stores the time the URL has been seen.
+	 */
+	struct GNUNET_TIME_Absolute time;
+	/**
+	 * @brief This member stores the highest parameter (crawling depth) the URL has been seen with.
+	 */
+	unsigned int parameter;
+};
+
+/**
+ * @brief This variable stores the hashes of all URLs seen recently mapped to the time and the parameter they have been seen with.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This variable stores the hashes of all URLs seen recently mapped to the time and the parameter they have been seen with. An URL seen again
+ * within the seen window is neither crawled nor recorded again unless its parameter is higher than before; a higher parameter means that the
+ * URLs found on its page have to be crawled to a greater depth.
+ */
+static struct GNUNET_CONTAINER_MultiHashMap *gnunet_search_url_processor_seen;
+/**
+ * @brief This variable stores the time an URL is remembered as seen.
+ */
+static struct GNUNET_TIME_Relative gnunet_search_url_processor_seen_window;
+/**
+ * @brief This variable stores the task periodically removing outdated entries from the map of seen URLs.
+ */
+static GNUNET_SCHEDULER_TaskIdentifier gnunet_search_url_processor_seen_cleanup_task;
+/**
+ * @brief This variable stores the number of peers closest to an URL that are responsible for crawling it; since closeness is judged from the
+ * neighbour table of every peer (see the flooding component) this is only the approximate number of crawlers per URL.
+ */
+static unsigned int gnunet_search_url_processor_crawl_redundancy;
+
+/**
+ * @brief This function is the iteration handler used to remove outdated entries from the map of seen URLs.
+ *
+ * @param cls the GNUnet closure (not used)
+ * @param key the hash of the URL
+ * @param value the seen entry of the URL
+ *
+ * @return GNUNET_YES in order to continue the iteration
+ */
+static int gnunet_search_url_processor_seen_cleanup_iterator(void *cls, GNUNET_HashCode const *key, void *value) {
+	struct gnunet_search_url_processor_seen_entry *seen = (struct gnunet_search_url_processor_seen_entry*) value;
+	if(GNUNET_TIME_absolute_get_duration(seen->time).rel_value >= gnunet_search_url_processor_seen_window.rel_value) {
+		GNUNET_CONTAINER_multihashmap_remove(gnunet_search_url_processor_seen, key, value);
+		GNUNET_free(seen);
+	}
+	return GNUNET_YES;
+}
+
+/**
+ * @brief This function periodically removes outdated entries from the map of seen URLs in order to keep its size bounded.
+ *
+ * @param cls the GNUnet closure (not used)
+ * @param tc the GNUnet task context (not used)
+ */
+static void gnunet_search_url_processor_seen_cleanup(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc) {
+	GNUNET_CONTAINER_multihashmap_iterate(gnunet_search_url_processor_seen,
+			&gnunet_search_url_processor_seen_cleanup_iterator, NULL);
+	gnunet_search_url_processor_seen_cleanup_task = GNUNET_SCHEDULER_add_delayed(
+			gnunet_search_url_processor_seen_window, &gnunet_search_url_processor_seen_cleanup, NULL);
+}
+
+/**
+ * @brief This function tests whether an URL has been seen within the seen window with at least the given parameter and records the current
+ * sighting.
  *
- * @param url a reference to a memory location to store a reference to the extracted URL in
- * @param parameter a reference to a memory location to store the extracted parameter in
- * @param prefix_length an offset into the data from which to search start the parsing
- * @param data the data containing the DHT value
- * @param the size of the data containing the DHT value
+ * @param key the hash of the URL
+ * @param parameter the parameter of the URL
  *
- * @return the length of the url
- */
-static size_t gnunet_search_url_processor_url_extract(char **url, unsigned int *parameter, size_t prefix_length, void const *data, size_t size) {
-	size_t position = prefix_length;
-	*parameter = 0;
-	for (size_t i = prefix_length; i < size; ++i)
-		if (((char*) data)[i] == ':') {
-			char parameter_str[i - prefix_length + 1];
-			memcpy(parameter_str, data + prefix_length, (i - prefix_length));
-			parameter_str[i - prefix_length] = 0;
-			sscanf(parameter_str, "%u", parameter);
-			position = i + 1;
-			break;
-		}
-
-	size_t url_length = size - position;
-	*url = (char*) GNUNET_malloc(url_length + 1);
-	memcpy(*url, data + position, url_length);
-	(*url)[url_length] = 0;
-
-	return url_length;
+ * @return a boolean value indicating whether the URL has been seen recently with a parameter not lower than the given one (1) or not (0)
+ */
+static char gnunet_search_url_processor_seen_test_and_set(GNUNET_HashCode const *key, unsigned int parameter) {
+	struct gnunet_search_url_processor_seen_entry *seen =
+			(struct gnunet_search_url_processor_seen_entry*) GNUNET_CONTAINER_multihashmap_get(
+					gnunet_search_url_processor_seen, key);
+	if(seen) {
+		if(GNUNET_TIME_absolute_get_duration(seen->time).rel_value < gnunet_search_url_processor_seen_window.rel_value
+				&& parameter <= seen->parameter)
+			return 1;
+	} else {
+		seen = (struct gnunet_search_url_processor_seen_entry*) GNUNET_malloc(
+				sizeof(struct gnunet_search_url_processor_seen_entry));
+		GNUNET_CONTAINER_multihashmap_put(gnunet_search_url_processor_seen, key, seen,
+				GNUNET_CONTAINER_MULTIHASHMAPOPTION_UNIQUE_FAST);
+	}
+	seen->time = GNUNET_TIME_absolute_get();
+	seen->parameter = parameter;
+	return 0;
+}
+
+/**
+ * @brief This function initialises the url processor component.
+ */
+void gnunet_search_url_processor_init() {
+	gnunet_search_url_processor_seen = GNUNET_CONTAINER_multihashmap_create(256);
+	gnunet_search_url_processor_seen_window = gnunet_search_globals_config_time_get("CRAWL_SEEN_WINDOW",
+			GNUNET_SEARCH_URL_PROCESSOR_SEEN_WINDOW_DEFAULT);
+	gnunet_search_url_processor_crawl_redundancy = (unsigned int) GNUNET_MAX(1,
+			gnunet_search_globals_config_number_get("CRAWL_REDUNDANCY",
+					GNUNET_SEARCH_URL_PROCESSOR_CRAWL_REDUNDANCY_DEFAULT));
+	gnunet_search_url_processor_seen_cleanup_task = GNUNET_SCHEDULER_add_delayed(
+			gnunet_search_url_processor_seen_window, &gnunet_search_url_processor_seen_cleanup, NULL);
 }
 
-//It therefor extracts the URL and its parameter (used for the crawling depth) from the raw DHT value and comm
+/**
+ * @brief This function releases all resources held by the url processor component.
+ */
+void gnunet_search_url_processor_free() {
+	GNUNET_SCHEDULER_cancel(gnunet_search_url_processor_seen_cleanup_task);
+
+	gnunet_search_url_processor_seen_window = GNUNET_TIME_UNIT_ZERO;
+	GNUNET_CONTAINER_multihashmap_iterate(gnunet_search_url_processor_seen,
+			&gnunet_search_url_processor_seen_cleanup_iterator, NULL);
+	GNUNET_CONTAINER_multihashmap_destroy(gnunet_search_url_processor_seen);
+}
 
 /**
- * @brief This function processes an incoming URL value received while monitoring the DHT.
+ * @brief This function processes an incoming URL received while monitoring the DHT.
  *
  * \latexonly \\ \\ \endlatexonly
  * \em Detailed \em description \n
- * This function processes an incoming URL value received while monitoring the DHT. It therefor extracts the URL and its parameter (used for the crawling depth)
- * from the raw DHT value; then it passes the URL to the crawling library. The resulting keywords found by the crawler are stored using the storage component.
+ * This function processes an incoming URL received while monitoring the DHT. The URL and its parameter (used for the crawling depth) have already
+ * been decoded from the URL record by the dht component. Every URL is only crawled by the peers closest to the hash of the URL (see the flooding
+ * component); all other peers merely record that the URL has been seen. An URL seen recently is skipped unless its parameter is higher than
+ * the one it has been seen with; this check is done before the responsibility check so that all peers keep the same record. The function passes the URL to the crawling library. The resulting keywords
+ * found by the crawler are stored using the storage component and published as keyword postings into the DHT.
  * In case the parameter value is greater than zero the URLs found by the crawler are again inserted into the DHT (with a lowered parameter).
  *
- * @param url a reference to a memory location to store a reference to the extracted URL in
- * @param parameter a reference to a memory location to store the extracted parameter in
- * @param prefix_length an offset into the data from which to search start the parsing
- * @param data the data containing the DHT value
- * @param the size of the data containing the DHT value
+ * @param key the hash of the URL
+ * @param url_data the URL; it is not terminated by a zero
+ * @param url_length the length of the URL
+ * @param parameter the parameter of the URL
  */
-void gnunet_search_url_processor_incoming_url_process(size_t prefix_length, void const *data, size_t size) {
-//	printf("data: %s\n", (char*)data);
+void gnunet_search_url_processor_incoming_url_process(GNUNET_HashCode const *key, char const *url_data,
+		size_t url_length, unsigned int parameter) {
+	if(gnunet_search_url_processor_seen_test_and_set(key, parameter)) {
+		GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# URLs seen again"), 1, GNUNET_NO);
+		return;
+	}
 
-	char *url;
-	unsigned int parameter;
-	/*size_t url_length = */gnunet_search_url_processor_url_extract(&url, &parameter, prefix_length, data, size);
+	if(!gnunet_search_flooding_closest_peers_contains_self(key, gnunet_search_url_processor_crawl_redundancy)) {
+		GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# URLs seen but not crawled"), 1,
+				GNUNET_NO);
+		return;
+	}
+
+	GNUNET_STATISTICS_update(gnunet_search_globals_statistics, gettext_noop("# URLs crawled"), 1, GNUNET_NO);
+
+	char *url = (char*) GNUNET_malloc(url_length + 1);
+	memcpy(url, url_data, url_length);
+	url[url_length] = 0;
 
 //	printf("Parameter: %u; url: %s\n", parameter, url);
 
@@ -120,6 +234,7 @@ void gnunet_search_url_processor_incoming_url_process(size_t prefix_length, void
 //		printf("Keyword: %s\n", keywords[i]);
 		gnunet_search_normalization_keyword_normalize(keywords[i]);
 		gnunet_search_storage_key_value_add(keywords[i], url);
+		gnunet_search_dht_keyword_put(keywords[i], url);
 		GNUNET_free(keywords[i]);
 	}
 
@@ -26,9 +26,15 @@
 #ifndef GNUNET_SEARCH_URL_PROCESSOR_H_
 #define GNUNET_SEARCH_URL_PROCESSOR_H_
 
+#include <gnunet/platform.h>
+#include <gnunet/gnunet_util_lib.h>
+
 #include "gnunet_protocols_search.h"
 
-extern void gnunet_search_url_processor_incoming_url_process(size_t prefix_length, const void *data, size_t size);
+extern void gnunet_search_url_processor_init();
+extern void gnunet_search_url_processor_free();
+extern void gnunet_search_url_processor_incoming_url_process(GNUNET_HashCode const *key, char const *url_data,
+		size_t url_length, unsigned int parameter);
 extern size_t gnunet_search_url_processor_cmd_urls_get(char ***urls, struct search_command const *cmd);
 
 #endif /* GNUNET_SEARCH_URL_PROCESSOR_H_ */
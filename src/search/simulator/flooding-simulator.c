@@ -0,0 +1,338 @@
+/**
+ * @file search/simulator/flooding-simulator.c
+ * @author Julian Kranz
+ * @date 18.10.2026
+ *
+ * @brief This file contains a simulator comparing the forwarding strategies of the GNUnet Search service's flooding component.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This file contains a simulator comparing the forwarding strategies of the GNUnet Search service's flooding component. It builds a random
+ * overlay, places a keyword on a number of random peers and issues requests from random peers using full flooding, gossip with a fixed fanout
+ * and random walkers with check-back. The simulator follows the rules of the flooding component: a peer answers a flow at most once, responses
+ * travel back along the reverse path of the first copy of the request seen by a peer and only random walkers are forwarded again in case a peer
+ * has already seen the flow. For every strategy the number of messages (requests and responses) sent per result found is printed.
+ */
+/*
+ *  This file is part of GNUnet Search.
+ *
+ *  GNUnet Search is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  GNUnet Search is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNUnet Search.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+/**
+ * @brief This constant defines the TTL of a request; it matches the TTL used by the flooding component.
+ */
+#define SIMULATOR_TTL 16
+
+/**
+ * @brief This enumeration defines the simulated forwarding strategies.
+ */
+enum simulator_strategy {
+	SIMULATOR_STRATEGY_FLOOD, SIMULATOR_STRATEGY_GOSSIP, SIMULATOR_STRATEGY_WALK
+};
+
+/**
+ * @brief This data structure represents a peer of the simulated overlay.
+ */
+struct simulator_peer {
+	/**
+	 * @brief This member stores the indices of the neighbours of the peer.
+	 */
+	unsigned int *neighbours;
+	/**
+	 * @brief This member stores the number of neighbours of the peer.
+	 */
+	unsigned int neighbours_length;
+	/**
+	 * @brief This member stores a boolean value indicating whether the peer stores the keyword searched for.
+	 */
+	char holder;
+	/**
+	 * @brief This member stores a boolean value indicating whether the peer has already seen the current flow.
+	 */
+	char seen;
+	/**
+	 * @brief This member stores the number of hops the first copy of the current request has travelled to reach the peer.
+	 */
+	unsigned int depth;
+};
+
+/**
+ * @brief This data structure represents a request in transit.
+ */
+struct simulator_message {
+	/**
+	 * @brief This member stores the index of the receiving peer.
+	 */
+	unsigned int peer;
+	/**
+	 * @brief This member stores the index of the sending peer or the number of peers in case the request originates at the receiver.
+	 */
+	unsigned int sender;
+	/**
+	 * @brief This member stores the TTL of the request.
+	 */
+	unsigned int ttl;
+	/**
+	 * @brief This member stores the number of hops the request has travelled.
+	 */
+	unsigned int depth;
+};
+
+/**
+ * @brief This variable stores the simulated overlay.
+ */
+static struct simulator_peer *peers;
+/**
+ * @brief This variable stores the number of peers of the overlay.
+ */
+static unsigned int peers_length;
+
+/**
+ * @brief This variable stores the FIFO of requests in transit; every request is sent at most once per link and hop so the size is bounded.
+ */
+static struct simulator_message *messages;
+/**
+ * @brief This variable stores the capacity of the request FIFO.
+ */
+static size_t messages_capacity;
+
+/**
+ * @brief This function returns a random number in the range [0, n).
+ *
+ * @param n the upper bound
+ *
+ * @return the random number
+ */
+static unsigned int simulator_random(unsigned int n) {
+	return (unsigned int) (((uint64_t) rand() * n) / ((uint64_t) RAND_MAX + 1));
+}
+
+/**
+ * @brief This function adds an undirected link between two peers unless they are already connected.
+ *
+ * @param a the first peer
+ * @param b the second peer
+ */
+static void simulator_link_add(unsigned int a, unsigned int b) {
+	if(a == b)
+		return;
+	for(unsigned int i = 0; i < peers[a].neighbours_length; ++i)
+		if(peers[a].neighbours[i] == b)
+			return;
+	peers[a].neighbours = (unsigned int*) realloc(peers[a].neighbours, sizeof(unsigned int) * (peers[a].neighbours_length + 1));
+	peers[a].neighbours[peers[a].neighbours_length++] = b;
+	peers[b].neighbours = (unsigned int*) realloc(peers[b].neighbours, sizeof(unsigned int) * (peers[b].neighbours_length + 1));
+	peers[b].neighbours[peers[b].neighbours_length++] = a;
+}
+
+/**
+ * @brief This function builds a random overlay; every peer opens a number of links to random peers.
+ *
+ * @param length the number of peers
+ * @param degree the number of links opened by every peer
+ */
+static void simulator_overlay_build(unsigned int length, unsigned int degree) {
+	peers_length = length;
+	peers = (struct simulator_peer*) calloc(length, sizeof(struct simulator_peer));
+	for(unsigned int i = 0; i < length; ++i)
+		for(unsigned int j = 0; j < degree; ++j)
+			simulator_link_add(i, simulator_random(length));
+
+	size_t links = 0;
+	for(unsigned int i = 0; i < length; ++i)
+		links += peers[i].neighbours_length;
+	messages_capacity = links * (SIMULATOR_TTL + 1) + length;
+	messages = (struct simulator_message*) malloc(sizeof(struct simulator_message) * messages_capacity);
+}
+
+/**
+ * @brief This function places the keyword on a number of random peers.
+ *
+ * @param replicas the number of peers storing the keyword
+ */
+static void simulator_keyword_place(unsigned int replicas) {
+	for(unsigned int i = 0; i < peers_length; ++i)
+		peers[i].holder = 0;
+	for(unsigned int i = 0; i < replicas; ++i)
+		peers[simulator_random(peers_length)].holder = 1;
+}
+
+/**
+ * @brief This function forwards a request to a number of random neighbours of a peer except the sender.
+ *
+ * @param peer the forwarding peer
+ * @param sender the peer the request has been received from
+ * @param count the number of neighbours
+ * @param ttl the TTL of the forwarded request
+ * @param depth the number of hops of the forwarded request
+ * @param tail the tail of the request FIFO
+ * @param sent the number of messages sent; it is incremented for every copy of the request
+ */
+static void simulator_random_forward(unsigned int peer, unsigned int sender, unsigned int count, unsigned int ttl,
+		unsigned int depth, size_t *tail, unsigned long *sent) {
+	struct simulator_peer *p = &peers[peer];
+	unsigned int candidates[p->neighbours_length];
+	unsigned int candidates_length = 0;
+	for(unsigned int i = 0; i < p->neighbours_length; ++i)
+		if(p->neighbours[i] != sender)
+			candidates[candidates_length++] = p->neighbours[i];
+
+	for(unsigned int i = 0; i < count && i < candidates_length; ++i) {
+		unsigned int j = i + simulator_random(candidates_length - i);
+		unsigned int swap = candidates[i];
+		candidates[i] = candidates[j];
+		candidates[j] = swap;
+
+		if(*tail == messages_capacity)
+			return;
+		messages[(*tail)++] = (struct simulator_message) { candidates[i], peer, ttl, depth };
+		(*sent)++;
+	}
+}
+
+/**
+ * @brief This function simulates one round of a request; i.e. the request and all of its copies are forwarded until their TTL is exceeded.
+ *
+ * @param origin the requesting peer
+ * @param strategy the forwarding strategy
+ * @param fanout the gossip fanout or the number of random walkers
+ * @param sent the number of messages sent; it is incremented for every request and response message
+ *
+ * @return the number of results found in this round
+ */
+static unsigned int simulator_round(unsigned int origin, enum simulator_strategy strategy, unsigned int fanout,
+		unsigned long *sent) {
+	size_t head = 0;
+	size_t tail = 0;
+	unsigned int results = 0;
+
+	messages[tail++] = (struct simulator_message) { origin, peers_length, SIMULATOR_TTL, 0 };
+	while(head < tail) {
+		struct simulator_message message = messages[head++];
+		struct simulator_peer *peer = &peers[message.peer];
+
+		if(!peer->seen) {
+			peer->seen = 1;
+			peer->depth = message.depth;
+			if(peer->holder && message.peer != origin) {
+				results++;
+				*sent += peer->depth;
+			}
+		} else if(strategy != SIMULATOR_STRATEGY_WALK)
+			continue;
+
+		if(message.ttl <= 1)
+			continue;
+
+		unsigned int count;
+		switch(strategy) {
+			case SIMULATOR_STRATEGY_FLOOD:
+				count = peer->neighbours_length;
+				break;
+			case SIMULATOR_STRATEGY_GOSSIP:
+				count = fanout;
+				break;
+			default:
+				count = message.sender == peers_length ? fanout : 1;
+				break;
+		}
+		simulator_random_forward(message.peer, message.sender, count, message.ttl - 1, message.depth + 1, &tail, sent);
+	}
+
+	return results;
+}
+
+/**
+ * @brief This function simulates a number of requests using one strategy and prints the results.
+ *
+ * @param name the name of the strategy
+ * @param strategy the forwarding strategy
+ * @param fanout the gossip fanout or the number of random walkers
+ * @param rounds the number of times random walkers are restarted in case no result has been found
+ * @param requests the number of requests to simulate
+ */
+static void simulator_strategy_run(char const *name, enum simulator_strategy strategy, unsigned int fanout,
+		unsigned int rounds, unsigned int requests) {
+	unsigned long sent = 0;
+	unsigned long results = 0;
+	unsigned int successful = 0;
+
+	for(unsigned int r = 0; r < requests; ++r) {
+		unsigned int origin = simulator_random(peers_length);
+		for(unsigned int i = 0; i < peers_length; ++i)
+			peers[i].seen = 0;
+
+		unsigned int found = simulator_round(origin, strategy, fanout, &sent);
+		for(unsigned int round = 0; strategy == SIMULATOR_STRATEGY_WALK && !found && round < rounds; ++round)
+			found = simulator_round(origin, strategy, fanout, &sent);
+
+		results += found;
+		if(found)
+			successful++;
+	}
+
+	printf("%-10s %6u %14.1f %14.2f %14.1f %10.1f%%\n", name, fanout, (double) sent / requests,
+			(double) results / requests, results ? (double) sent / results : 0.0, 100.0 * successful / requests);
+}
+
+/**
+ * @brief This function is the main function of the simulator.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This function is the main function of the simulator. The optional arguments are the number of peers, the number of links opened by every peer,
+ * the number of peers storing the keyword, the number of requests and the seed of the random number generator.
+ *
+ * @param argc the number of arguments from the command line
+ * @param argv the command line arguments
+ * @return 0 in case of success, 1 on error
+ */
+int main(int argc, char **argv) {
+	unsigned int length = argc > 1 ? (unsigned int) atoi(argv[1]) : 2000;
+	unsigned int degree = argc > 2 ? (unsigned int) atoi(argv[2]) : 4;
+	unsigned int replicas = argc > 3 ? (unsigned int) atoi(argv[3]) : 20;
+	unsigned int requests = argc > 4 ? (unsigned int) atoi(argv[4]) : 200;
+	unsigned int seed = argc > 5 ? (unsigned int) atoi(argv[5]) : 42;
+	if(!length || !requests) {
+		fprintf(stderr, "Usage: %s [peers [degree [replicas [requests [seed]]]]]\n", argv[0]);
+		return 1;
+	}
+
+	srand(seed);
+	simulator_overlay_build(length, degree);
+	simulator_keyword_place(replicas);
+
+	printf("peers: %u, links per peer: %u, replicas: %u, requests: %u, TTL: %u\n\n", length, degree, replicas, requests,
+			SIMULATOR_TTL);
+	printf("%-10s %6s %14s %14s %14s %11s\n", "strategy", "fanout", "messages/req", "results/req", "messages/res",
+			"success");
+	simulator_strategy_run("flood", SIMULATOR_STRATEGY_FLOOD, 0, 0, requests);
+	for(unsigned int fanout = 2; fanout <= 4; ++fanout)
+		simulator_strategy_run("gossip", SIMULATOR_STRATEGY_GOSSIP, fanout, 0, requests);
+	for(unsigned int fanout = 2; fanout <= 8; fanout *= 2)
+		simulator_strategy_run("walk", SIMULATOR_STRATEGY_WALK, fanout, 3, requests);
+
+	for(unsigned int i = 0; i < peers_length; ++i)
+		free(peers[i].neighbours);
+	free(peers);
+	free(messages);
+
+	return 0;
+}
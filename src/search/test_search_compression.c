@@ -0,0 +1,232 @@
+/**
+ * @file search/test_search_compression.c
+ * @author Julian Kranz
+ * @date 18.10.2026
+ *
+ * @brief This file contains the test case of the GNUnet Search service's compression component.
+ *
+ * \latexonly \\ \\ \endlatexonly
+ * \em Detailed \em description \n
+ * This file contains the test case of the GNUnet Search service's compression component. Lists of strings are encoded and decoded again; since
+ * the encoder sorts the strings before front coding them the decoded list is compared to the sorted original list. Encoded data that has been
+ * truncated or corrupted has to be rejected by the decoder.
+ */
+/*
+ *  This file is part of GNUnet Search.
+ *
+ *  GNUnet Search is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  GNUnet Search is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with GNUnet Search.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <zlib.h>
+
+#include <gnunet/platform.h>
+#include <gnunet/gnunet_util_lib.h>
+
+#include "service/compression/compression.h"
+
+/**
+ * @brief This constant defines the maximal size of a decoded list of strings used by the test.
+ */
+#define TEST_SEARCH_COMPRESSION_MAXIMAL_SIZE 65536
+
+/**
+ * @brief This function compares two strings referenced by array elements; it is used to sort the strings.
+ *
+ * @param a a reference to the first string
+ * @param b a reference to the second string
+ *
+ * @return the result of comparing the strings (see strcmp())
+ */
+static int test_search_compression_string_compare(void const *a, void const *b) {
+	return strcmp(*(char const * const *) a, *(char const * const *) b);
+}
+
+/**
+ * @brief This function builds a list of strings from an array of strings.
+ *
+ * @param strings the array of strings
+ * @param strings_length the length of the array
+ * @param sort a boolean value indicating whether the strings are to be sorted (1) or not (0)
+ * @param list a reference to a variable the function stores the list in; the caller has to free the list.
+ *
+ * @return the size of the list
+ */
+static size_t test_search_compression_list_build(char const **strings, size_t strings_length, char sort, char **list) {
+	char const **ordered = (char const**) GNUNET_malloc(sizeof(char const*) * (strings_length + 1));
+	memcpy(ordered, strings, sizeof(char const*) * strings_length);
+	if(sort)
+		qsort(ordered, strings_length, sizeof(char const*), &test_search_compression_string_compare);
+
+	size_t list_size = 0;
+	for(size_t i = 0; i < strings_length; ++i)
+		list_size += strlen(ordered[i]) + 1;
+	*list = (char*) GNUNET_malloc(list_size + 1);
+	size_t offset = 0;
+	for(size_t i = 0; i < strings_length; ++i) {
+		memcpy(*list + offset, ordered[i], strlen(ordered[i]) + 1);
+		offset += strlen(ordered[i]) + 1;
+	}
+	GNUNET_free(ordered);
+	return list_size;
+}
+
+/**
+ * @brief This function encodes a list of strings, decodes it again and compares the result to the sorted list.
+ *
+ * @param strings the array of strings
+ * @param strings_length the length of the array
+ *
+ * @return 0 on success, 1 otherwise
+ */
+static int test_search_compression_round_trip(char const **strings, size_t strings_length) {
+	char *list;
+	size_t list_size = test_search_compression_list_build(strings, strings_length, 0, &list);
+	char *sorted;
+	size_t sorted_size = test_search_compression_list_build(strings, strings_length, 1, &sorted);
+
+	int ret = 0;
+	void *encoded;
+	size_t encoded_size = gnunet_search_compression_encode(list, list_size, &encoded);
+	if(!encoded_size || encoded_size >= list_size) {
+		fprintf(stderr, "Encoding of %zu strings failed\n", strings_length);
+		ret = 1;
+	} else {
+		void *decoded;
+		size_t decoded_size = gnunet_search_compression_decode(encoded, encoded_size, &decoded,
+				TEST_SEARCH_COMPRESSION_MAXIMAL_SIZE);
+		if(decoded_size != sorted_size || memcmp(decoded, sorted, sorted_size)) {
+			fprintf(stderr, "Decoding of %zu strings does not match the sorted list\n", strings_length);
+			ret = 1;
+		}
+		if(decoded_size)
+			GNUNET_free(decoded);
+		if(gnunet_search_compression_decode(encoded, encoded_size, &decoded, sorted_size - 1)) {
+			fprintf(stderr, "Decoding beyond the maximal size accepted\n");
+			GNUNET_free(decoded);
+			ret = 1;
+		}
+		GNUNET_free(encoded);
+	}
+	GNUNET_free(list);
+	GNUNET_free(sorted);
+	return ret;
+}
+
+/**
+ * @brief This function tests that empty and malformed lists are not encoded.
+ *
+ * @return 0 on success, 1 otherwise
+ */
+static int test_search_compression_empty() {
+	void *encoded;
+	if(gnunet_search_compression_encode("", 0, &encoded)) {
+		fprintf(stderr, "Empty list encoded\n");
+		return 1;
+	}
+	if(gnunet_search_compression_encode("unterminated", 12, &encoded)) {
+		fprintf(stderr, "Unterminated list encoded\n");
+		return 1;
+	}
+	void *decoded;
+	if(gnunet_search_compression_decode("", 0, &decoded, TEST_SEARCH_COMPRESSION_MAXIMAL_SIZE)) {
+		fprintf(stderr, "Empty data decoded\n");
+		return 1;
+	}
+	return 0;
+}
+
+/**
+ * @brief This function tests that truncated and corrupted encodings are rejected.
+ *
+ * @param strings the array of strings to encode
+ * @param strings_length the length of the array
+ *
+ * @return 0 on success, 1 otherwise
+ */
+static int test_search_compression_corrupt(char const **strings, size_t strings_length) {
+	char *list;
+	size_t list_size = test_search_compression_list_build(strings, strings_length, 0, &list);
+	void *encoded;
+	size_t encoded_size = gnunet_search_compression_encode(list, list_size, &encoded);
+	GNUNET_free(list);
+	if(!encoded_size) {
+		fprintf(stderr, "Encoding failed\n");
+		return 1;
+	}
+
+	int ret = 0;
+	void *decoded;
+	for(size_t size = 0; size < encoded_size; size += 7)
+		if(gnunet_search_compression_decode(encoded, size, &decoded, TEST_SEARCH_COMPRESSION_MAXIMAL_SIZE)) {
+			fprintf(stderr, "Truncated encoding of %zu bytes accepted\n", size);
+			GNUNET_free(decoded);
+			ret = 1;
+		}
+
+	uint8_t *corrupt = (uint8_t*) GNUNET_malloc(encoded_size);
+	memcpy(corrupt, encoded, encoded_size);
+	uint32_t size_network = htonl(ntohl(*(uint32_t*) corrupt) + 1);
+	memcpy(corrupt, &size_network, sizeof(uint32_t));
+	if(gnunet_search_compression_decode(corrupt, encoded_size, &decoded, TEST_SEARCH_COMPRESSION_MAXIMAL_SIZE)) {
+		fprintf(stderr, "Encoding with a wrong size accepted\n");
+		GNUNET_free(decoded);
+		ret = 1;
+	}
+	GNUNET_free(corrupt);
+	GNUNET_free(encoded);
+
+	/*
+	 * A well-formed deflate stream carrying a prefix longer than the previous string
+	 */
+	uint8_t front_coded[] = { 0, 'a', 0, 5, 'b', 0 };
+	uLongf deflated_size = compressBound(sizeof(front_coded));
+	uint8_t *crafted = (uint8_t*) GNUNET_malloc(sizeof(uint32_t) + deflated_size);
+	compress2(crafted + sizeof(uint32_t), &deflated_size, front_coded, sizeof(front_coded), Z_BEST_COMPRESSION);
+	size_network = htonl(sizeof(front_coded));
+	memcpy(crafted, &size_network, sizeof(uint32_t));
+	if(gnunet_search_compression_decode(crafted, sizeof(uint32_t) + deflated_size, &decoded,
+			TEST_SEARCH_COMPRESSION_MAXIMAL_SIZE)) {
+		fprintf(stderr, "Encoding with an invalid prefix accepted\n");
+		GNUNET_free(decoded);
+		ret = 1;
+	}
+	GNUNET_free(crafted);
+	return ret;
+}
+
+int main(int argc, char *argv[]) {
+	GNUNET_log_setup("test_search_compression", "WARNING", NULL);
+
+	char single[512];
+	memset(single, 'a', sizeof(single) - 1);
+	single[sizeof(single) - 1] = 0;
+	char const *single_strings[] = { single };
+
+	char const *duplicate_strings[] = { "http://www.gnunet.org/", "http://www.example.org/index.html",
+			"http://www.gnunet.org/", "http://www.example.org/", "http://www.gnunet.org/", "http://www.example.org/index.html",
+			"http://www.gnunet.org/", "http://www.example.org/" };
+
+	int ret = 0;
+	ret |= test_search_compression_empty();
+	ret |= test_search_compression_round_trip(single_strings, 1);
+	ret |= test_search_compression_round_trip(duplicate_strings, sizeof(duplicate_strings) / sizeof(duplicate_strings[0]));
+	ret |= test_search_compression_corrupt(duplicate_strings, sizeof(duplicate_strings) / sizeof(duplicate_strings[0]));
+	return ret;
+}
+
+/* end of test_search_compression.c */
@@ -30,6 +30,8 @@
 #include <netinet/in.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/time.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <gnunet/platform.h>
@@ -59,8 +61,20 @@ struct gnunet_search_web_query {
 	unsigned int num_res;
 	struct gnunet_search_web_query * next;
 	char **results;
+	time_t polled; //!< time the results have been polled last
+	int running; //!< whether the service is still searching
 };
 
+/**
+ * @brief Seconds without a poll for results after which a search is considered abandoned
+ */
+#define GNUNET_SEARCH_WEB_ABANDON_TIMEOUT 30
+
+/**
+ * @brief Seconds between two checks for abandoned searches
+ */
+#define GNUNET_SEARCH_WEB_ABANDON_CHECK_INTERVAL 10
+
 /**
  * @brief A list of queries
  */
@@ -227,10 +241,11 @@ static struct gnunet_search_web_query * gnunet_search_web_lookup_query(unsigned
 /**
  * @brief Extract results from GNUnet message
  *
+ * @param session_cls communication session closure (not used)
  * @param size message size
  * @param buffer message
  */
-static void gnunet_search_web_receive_response(size_t size, void *buffer) {
+static void gnunet_search_web_receive_response(void *session_cls, size_t size, void *buffer) {
 	GNUNET_assert(size >= sizeof(struct search_response));
 	if (size < sizeof(struct search_response))
 		return;
@@ -243,16 +258,18 @@ static void gnunet_search_web_receive_response(size_t size, void *buffer) {
 
 	gnunet_search_server_communication_receive();
 
-	if (response->type != GNUNET_SEARCH_RESPONSE_TYPE_RESULT)
-		return;
-
-	size_t result_length = size - sizeof(struct search_response);
-
 	// do we actually know the query?
 	struct gnunet_search_web_query * query = gnunet_search_web_lookup_query(response->id);
 	if (!query)
 		return;
 
+	if (response->type == GNUNET_SEARCH_RESPONSE_TYPE_DONE)
+		query->running = 0;
+	if (response->type != GNUNET_SEARCH_RESPONSE_TYPE_RESULT)
+		return;
+
+	size_t result_length = size - sizeof(struct search_response);
+
 	char results[result_length + 1];
 	memcpy(results, response + 1, result_length);
 	results[result_length] = 0;
@@ -282,9 +299,11 @@ static void gnunet_search_web_render_results(struct gnunet_search_web_request_co
 	json_t *arr = json_array();
 
 	struct gnunet_search_web_query * query = gnunet_search_web_lookup_query(query_id);
-	if (query)
+	if (query) {
+		query->polled = time(0);
 		for (unsigned int i = offset; i < query->num_res; i++)
 			json_array_append_new(arr, json_string(query->results[i]));
+	}
 
 	context->output = json_dumps(arr, 0);
 }
@@ -307,6 +326,8 @@ static unsigned short gnunet_search_web_start_search(const char *q) {
 	query->next = 0;
 	query->results = GNUNET_malloc(0);
 	query->num_res = 0;
+	query->polled = time(0);
+	query->running = 1;
 	
 	if (gnunet_search_web_query_list->first && gnunet_search_web_query_list->last)
 		gnunet_search_web_query_list->last->next = query;
@@ -330,13 +351,64 @@ static unsigned short gnunet_search_web_start_search(const char *q) {
 	cmd->size = serialized_size;
 	cmd->id = id;
 
-	gnunet_search_communication_transmit(serialized, serialized_size);
+	gnunet_search_server_communication_transmit(serialized, serialized_size);
 
 	GNUNET_free(serialized);
 
 	return id;
 }
 
+/**
+ * @brief Tell the service to stop searching for a query
+ *
+ * The results received so far are kept.
+ *
+ * @param id query id
+ */
+static void gnunet_search_web_cancel_search(unsigned short id) {
+	struct gnunet_search_web_query * query = gnunet_search_web_lookup_query(id);
+	if (!query || !query->running)
+		return;
+	query->running = 0;
+
+	struct search_command *cmd = GNUNET_malloc(sizeof(struct search_command));
+	cmd->action = GNUNET_SEARCH_ACTION_CANCEL;
+	cmd->size = sizeof(struct search_command);
+	cmd->id = id;
+
+	gnunet_search_server_communication_transmit(cmd, sizeof(struct search_command));
+
+	GNUNET_free(cmd);
+}
+
+/**
+ * @brief Cancel all searches whose results have not been polled for a while
+ *
+ * A browser closing the page without telling us stops polling; the search is
+ * cancelled so that it stops consuming network resources.
+ */
+static void gnunet_search_web_cancel_abandoned() {
+	if (!gnunet_search_web_query_list)
+		return;
+
+	time_t now = time(0);
+	unsigned short id = 1;
+	for (struct gnunet_search_web_query * query = gnunet_search_web_query_list->first; query; query = query->next, id++)
+		if (query->running && now - query->polled > GNUNET_SEARCH_WEB_ABANDON_TIMEOUT)
+			gnunet_search_web_cancel_search(id);
+}
+
+/**
+ * @brief Task periodically cancelling abandoned searches
+ *
+ * @param cls unused
+ * @param tc unused
+ */
+static void gnunet_search_web_cancel_abandoned_task(void *cls, const struct GNUNET_SCHEDULER_TaskContext *tc) {
+	gnunet_search_web_cancel_abandoned();
+	GNUNET_SCHEDULER_add_delayed(GNUNET_TIME_relative_multiply(GNUNET_TIME_UNIT_SECONDS, GNUNET_SEARCH_WEB_ABANDON_CHECK_INTERVAL), &gnunet_search_web_cancel_abandoned_task, 0);
+}
+
 /**
  * @brief MHD_AccessHandlerCallback for the webserver
  *
@@ -365,6 +437,13 @@ static int gnunet_search_web_uri_handler(void *cls, struct MHD_Connection *conne
 			gnunet_search_web_render_page(&context, q, qid);
 		} else if (!strcmp(url, "/results")) {
 			gnunet_search_web_render_results(&context, atoi(MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "q")), atoi(MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "o")));
+		} else if (!strcmp(url, "/cancel")) {
+			const char *q = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "q");
+			if (q)
+				gnunet_search_web_cancel_search(atoi(q));
+			context.status = MHD_HTTP_OK;
+			context.output = GNUNET_malloc(1);
+			context.output[0] = 0;
 		} else {
 			context.output = GNUNET_malloc(16);
 			strcpy(context.output, "404 - Not Found");
@@ -409,7 +488,9 @@ static void gnunet_search_web_process_requests(void * cls, const struct GNUNET_S
 	int max = 0;
 	if (MHD_get_fdset(cls, &rs, &ws, &es, &max) != MHD_YES)
 		exit(1);
-	select(max + 1, &rs, &ws, &es, 0);
+	// return to the scheduler once in a while so that its other tasks get to run
+	struct timeval timeout = { 1, 0 };
+	select(max + 1, &rs, &ws, &es, &timeout);
 	MHD_run(cls);
 	GNUNET_SCHEDULER_add_delayed(GNUNET_TIME_UNIT_ZERO, &gnunet_search_web_process_requests, cls);
 }
@@ -444,6 +525,7 @@ static void gnunet_search_web_run(void *cls, char * const *args, const char *cfg
 	struct MHD_Daemon * daemon = MHD_start_daemon(0, port, 0, 0, gnunet_search_web_uri_handler, 0, MHD_OPTION_SOCK_ADDR, &addr, MHD_OPTION_END);
 	GNUNET_SCHEDULER_add_delayed(GNUNET_TIME_UNIT_FOREVER_REL, &gnunet_search_web_shutdown_task, daemon);
 	GNUNET_SCHEDULER_add_delayed(GNUNET_TIME_UNIT_ZERO, &gnunet_search_web_process_requests, daemon);
+	GNUNET_SCHEDULER_add_delayed(GNUNET_TIME_relative_multiply(GNUNET_TIME_UNIT_SECONDS, GNUNET_SEARCH_WEB_ABANDON_CHECK_INTERVAL), &gnunet_search_web_cancel_abandoned_task, 0);
 }
 
 /**
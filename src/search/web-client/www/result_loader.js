@@ -30,3 +30,13 @@ function load_results(query, offset, timeout) {
 	};
 	xmlHttp.send(null);
 }
+
+function cancel_search(query) {
+	var url = 'cancel?q='+encodeURIComponent(query);
+	if (navigator.sendBeacon && navigator.sendBeacon(url)) {
+		return;
+	}
+	var xmlHttp = new XMLHttpRequest();
+	xmlHttp.open('GET', url, true);
+	xmlHttp.send(null);
+}